@@ -0,0 +1,110 @@
+// alloc_tracker.h
+// Counts heap allocations per thread so searches can report how many
+// allocations (and bytes) each phase made.
+//
+// The counting itself is a replacement of the global operator new/delete,
+// which may only exist once per program. Define CHESS_ALLOC_TRACKER_IMPL in
+// exactly one .cpp file and include this header there before any other
+// project header (they include it too, and #pragma once would skip the hook):
+//
+//   #define CHESS_ALLOC_TRACKER_IMPL
+//   #include "alloc_tracker.h"
+//
+// Without that the counters simply stay at zero. Every replaceable form of
+// operator new is hooked (array, nothrow and std::align_val_t included), so
+// no allocation escapes the budgets. The counters are thread-local, so
+// worker threads never contend on them.
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+struct AllocCounters {
+    uint64_t allocs = 0;
+    uint64_t bytes = 0;
+    uint64_t frees = 0;
+};
+
+inline thread_local AllocCounters tlsAllocCounters;
+
+// True once a program has installed the operator new hook
+inline bool allocTrackingInstalled = false;
+
+inline const AllocCounters& threadAllocCounters() { return tlsAllocCounters; }
+
+// Allocations made by this thread since construction (or the last reset)
+class AllocScope {
+public:
+    AllocScope() { reset(); }
+    void reset() { start = tlsAllocCounters; }
+    uint64_t allocs() const { return tlsAllocCounters.allocs - start.allocs; }
+    uint64_t bytes() const { return tlsAllocCounters.bytes - start.bytes; }
+
+private:
+    AllocCounters start;
+};
+
+#ifdef CHESS_ALLOC_TRACKER_IMPL
+
+[[maybe_unused]] static bool allocTrackerInstall = (allocTrackingInstalled = true);
+
+namespace alloc_tracker_detail {
+
+// Every replaced operator new ends here, so plain, array, nothrow and
+// over-aligned allocations are all counted
+inline void* allocate(size_t n, size_t align) {
+    tlsAllocCounters.allocs++;
+    tlsAllocCounters.bytes += n;
+    if (n == 0) n = 1;
+    if (align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) return std::malloc(n);
+    return std::aligned_alloc(align, (n + align - 1) / align * align); // size must be a multiple
+}
+
+inline void* allocateOrThrow(size_t n, size_t align) {
+    if (void* p = allocate(n, align)) return p;
+    throw std::bad_alloc();
+}
+
+inline void release(void* p) {
+    if (p) tlsAllocCounters.frees++;
+    std::free(p);
+}
+
+} // namespace alloc_tracker_detail
+
+void* operator new(size_t n) { return alloc_tracker_detail::allocateOrThrow(n, 0); }
+void* operator new[](size_t n) { return alloc_tracker_detail::allocateOrThrow(n, 0); }
+void* operator new(size_t n, std::align_val_t a) { return alloc_tracker_detail::allocateOrThrow(n, (size_t)a); }
+void* operator new[](size_t n, std::align_val_t a) { return alloc_tracker_detail::allocateOrThrow(n, (size_t)a); }
+void* operator new(size_t n, const std::nothrow_t&) noexcept { return alloc_tracker_detail::allocate(n, 0); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return alloc_tracker_detail::allocate(n, 0); }
+void* operator new(size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return alloc_tracker_detail::allocate(n, (size_t)a);
+}
+void* operator new[](size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return alloc_tracker_detail::allocate(n, (size_t)a);
+}
+
+// GCC pairs these with the library's new and warns that the memory came
+// from malloc, which is exactly what the replacements above use
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { alloc_tracker_detail::release(p); }
+void operator delete[](void* p) noexcept { alloc_tracker_detail::release(p); }
+void operator delete(void* p, size_t) noexcept { alloc_tracker_detail::release(p); }
+void operator delete[](void* p, size_t) noexcept { alloc_tracker_detail::release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { alloc_tracker_detail::release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alloc_tracker_detail::release(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { alloc_tracker_detail::release(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { alloc_tracker_detail::release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { alloc_tracker_detail::release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { alloc_tracker_detail::release(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { alloc_tracker_detail::release(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { alloc_tracker_detail::release(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
@@ -0,0 +1,404 @@
+// bench.cpp
+// Microbenchmarks for the move generators and the search engines.
+//
+//   g++ -O2 -std=c++17 bench.cpp -o chess_bench -lpthread
+//   ./chess_bench [--quick] [--json results.json] [--prom stats.prom] [--perf] [--seed N]
+//
+// Allocations are counted per query and per search phase. Engines that
+// promise an allocation budget (SearchEngine::allocBudgetPerQuery) are checked
+// against it and the run fails with exit code 3 when one goes over.
+//
+// --perf adds an untimed pass per configuration with hardware counters
+// (perf_counters.h) attached to the engines; the per-phase, per-piece counts
+// go into the "perf" section of the JSON output.
+//
+// The startup suite times the first use of the move tables for each board
+// size (embedded at compile time for 8x8, built lazily otherwise) against a
+// warm lookup. It runs before the search suite, which would warm them up.
+//
+// Every board, obstacle layout and query list comes from a fixed seed, so two
+// runs on the same machine measure exactly the same work.
+
+// Counts every operator new in this program. Has to come before the other
+// project headers, which include alloc_tracker.h without the hook.
+#define CHESS_ALLOC_TRACKER_IMPL
+#include "alloc_tracker.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "chess_moves.h"
+#include "chess_search.h"
+#include "latency_histogram.h"
+#include "move_tables.h"
+#include "perf_counters.h"
+#include "search_stats.h"
+
+// --- Results ---
+
+struct BenchRecord {
+    std::string suite;   // "movegen", "startup" or "search"
+    std::string name;    // generator or engine
+    std::string piece;
+    int boardSize = BOARD_SIZE;
+    double density = 0.0;
+    uint64_t queries = 0;
+    double nsPerQuery = 0.0;
+    double nodesPerSec = 0.0;
+    double warmSeconds = -1.0; // startup rows: a second, warm lookup; < 0 elsewhere
+    double allocsPerQuery = 0.0;
+    double allocBytesPerQuery = 0.0;
+    double phaseAllocsPerQuery[PHASE_COUNT] = {0.0, 0.0, 0.0};
+    double allocBudget = -1.0; // < 0: no budget
+    size_t stateBytes = 0;
+    uint64_t latencyNs[4] = {0, 0, 0, 0}; // p50, p99, p99.9, max
+
+    bool overBudget() const { return allocBudget >= 0.0 && allocsPerQuery > allocBudget; }
+};
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+// --- Move generator suite (the visualizer's 8x8 generators) ---
+
+static BenchRecord benchGenerator(const char* name, PieceType piece, std::vector<Point> (*gen)(const Point&), uint64_t iterations) {
+    volatile size_t sink = 0;
+    AllocScope allocs;
+    auto t0 = Clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        Point p = {(int)(i % BOARD_SIZE), (int)((i / BOARD_SIZE) % BOARD_SIZE)};
+        sink = sink + gen(p).size();
+    }
+    double secs = secondsSince(t0);
+
+    BenchRecord r;
+    r.suite = "movegen";
+    r.name = name;
+    r.piece = pieceName(piece);
+    r.queries = iterations;
+    r.nsPerQuery = secs * 1e9 / iterations;
+    r.nodesPerSec = iterations / secs;
+    r.allocsPerQuery = double(allocs.allocs()) / iterations;
+    r.allocBytesPerQuery = double(allocs.bytes()) / iterations;
+    r.stateBytes = 0;
+    return r;
+}
+
+// --- Startup suite: first use of the move tables ---
+
+static BenchRecord tableRecord(const char* name, const char* piece, int size, double coldSecs, double warmSecs,
+                               size_t bytes) {
+    BenchRecord r;
+    r.suite = "startup";
+    r.name = name;
+    r.piece = piece;
+    r.boardSize = size;
+    r.queries = 1;
+    r.nsPerQuery = coldSecs * 1e9;
+    r.warmSeconds = warmSecs;
+    r.stateBytes = bytes;
+    return r;
+}
+
+static void benchTableInit(int size, std::vector<BenchRecord>& records) {
+    const PieceType steppers[2] = {KNIGHT_P, KING_P};
+    size_t cells = (size_t)size * size;
+    for (PieceType piece : steppers) {
+        auto t0 = Clock::now();
+        StepTableView t = stepTable(size, piece);
+        double cold = secondsSince(t0);
+        t0 = Clock::now();
+        stepTable(size, piece);
+        double warm = secondsSince(t0);
+        size_t bytes = (cells + 1 + t.offsets[cells]) * sizeof(uint32_t);
+        records.push_back(tableRecord("step_table", pieceName(piece), size, cold, warm, bytes));
+    }
+    auto t0 = Clock::now();
+    rayTable(size);
+    double cold = secondsSince(t0);
+    t0 = Clock::now();
+    rayTable(size);
+    double warm = secondsSince(t0);
+    records.push_back(tableRecord("ray_table", "sliding", size, cold, warm, cells * 8 * sizeof(uint32_t)));
+}
+
+// --- Search suite ---
+
+struct Workload {
+    Board board;
+    std::vector<std::pair<Point, Point>> queries;
+};
+
+static Workload makeWorkload(int size, double density, int queryCount, uint32_t seed) {
+    Workload w;
+    std::mt19937 rng(seed);
+    w.board.size = size;
+    w.board.blocked.assign(size * size, 0);
+    std::bernoulli_distribution block(density);
+    for (auto& b : w.board.blocked) b = block(rng) ? 1 : 0;
+
+    std::vector<Point> freeSquares;
+    for (int i = 0; i < w.board.cells(); i++) {
+        if (!w.board.blocked[i]) freeSquares.push_back(w.board.point(i));
+    }
+    if (freeSquares.empty()) {
+        w.board.blocked[0] = 0;
+        freeSquares.push_back({0, 0});
+    }
+    std::uniform_int_distribution<size_t> pick(0, freeSquares.size() - 1);
+    for (int i = 0; i < queryCount; i++) {
+        w.queries.push_back({freeSquares[pick(rng)], freeSquares[pick(rng)]});
+    }
+    return w;
+}
+
+static BenchRecord benchSearch(SearchEngine& engine, PieceType piece, const Workload& w, double density,
+                               LabeledStats& totals, LatencyHistogram& latencies) {
+    // One untimed query so engines that keep buffers are measured warmed up
+    engine.search(w.board, piece, w.queries[0].first, w.queries[0].second);
+
+    volatile int sink = 0;
+    uint64_t nodes = 0;
+    size_t peakState = 0;
+    SearchStats sum;
+    LatencyHistogram hist;
+    AllocScope allocs;
+    auto t0 = Clock::now();
+    for (const auto& q : w.queries) {
+        auto q0 = Clock::now();
+        SearchResult res = engine.search(w.board, piece, q.first, q.second);
+        hist.record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - q0).count());
+        sink = sink + res.distance;
+        nodes += res.stats.nodesPopped;
+        totals.searches++;
+        totals.stats.merge(res.stats);
+        sum.merge(res.stats);
+        if (engine.stateBytes() > peakState) peakState = engine.stateBytes();
+    }
+    double secs = secondsSince(t0);
+
+    BenchRecord r;
+    r.suite = "search";
+    r.name = engine.name();
+    r.piece = pieceName(piece);
+    r.boardSize = w.board.size;
+    r.density = density;
+    r.queries = w.queries.size();
+    r.nsPerQuery = secs * 1e9 / w.queries.size();
+    r.nodesPerSec = nodes / secs;
+    r.allocsPerQuery = double(allocs.allocs()) / w.queries.size();
+    r.allocBytesPerQuery = double(allocs.bytes()) / w.queries.size();
+    for (int p = 0; p < PHASE_COUNT; p++) r.phaseAllocsPerQuery[p] = double(sum.phaseAllocs[p]) / w.queries.size();
+    r.allocBudget = engine.allocBudgetPerQuery();
+    r.stateBytes = peakState;
+    r.latencyNs[0] = hist.percentile(0.50);
+    r.latencyNs[1] = hist.percentile(0.99);
+    r.latencyNs[2] = hist.percentile(0.999);
+    r.latencyNs[3] = hist.max();
+    latencies.merge(hist);
+    return r;
+}
+
+// Untimed rerun of a workload with hardware counters attached to the engine
+static void profileSearch(SearchEngine& engine, PhaseProfiler& profiler, PieceType piece, const Workload& w) {
+    engine.setProfiler(&profiler);
+    for (const auto& q : w.queries) engine.search(w.board, piece, q.first, q.second);
+    engine.setProfiler(nullptr);
+}
+
+// --- Output ---
+
+static void printRecord(const BenchRecord& r) {
+    std::printf("%-8s %-12s %-7s %4d %5.2f %8llu %12.1f %14.0f %10.2f %10.0f %10zu%s\n",
+                r.suite.c_str(), r.name.c_str(), r.piece.c_str(), r.boardSize, r.density,
+                (unsigned long long)r.queries, r.nsPerQuery, r.nodesPerSec, r.allocsPerQuery,
+                r.allocBytesPerQuery, r.stateBytes, r.overBudget() ? "  OVER ALLOCATION BUDGET" : "");
+}
+
+static std::string perfJSON(bool requested, const std::vector<PhaseProfiler>& profilers) {
+    std::ostringstream out;
+    // Counts are reported only when every engine's counters opened: main()
+    // skips the profiled pass for all of them as soon as one fails
+    const PhaseProfiler* failed = nullptr;
+    for (const auto& prof : profilers) {
+        if (!prof.isEnabled() && !failed) failed = &prof;
+    }
+    bool available = requested && !profilers.empty() && !failed;
+    out << "  \"perf\": {\"available\": " << (available ? "true" : "false");
+    if (requested && !available) {
+        std::string reason = failed ? failed->error() : "";
+        for (auto& c : reason) if (c == '"' || c == '\\') c = '\'';
+        out << ", \"reason\": \"" << reason << "\"";
+    }
+    out << ", \"results\": [";
+    bool first = true;
+    for (int e = 0; available && e < ENGINE_COUNT; e++) {
+        for (int p = 0; p < PIECE_COUNT; p++) {
+            for (int ph = 0; ph < PERF_PHASE_COUNT; ph++) {
+                const PerfTotals& t = profilers[e].total((PieceType)p, (PerfPhase)ph);
+                if (t.entries == 0) continue;
+                out << (first ? "\n" : ",\n") << "    {\"engine\": \"" << engineName((EngineType)e)
+                    << "\", \"piece\": \"" << pieceName((PieceType)p)
+                    << "\", \"phase\": \"" << perfPhaseName((PerfPhase)ph) << "\", \"entries\": " << t.entries;
+                for (int c = 0; c < PERF_EVENT_COUNT; c++) {
+                    out << ", \"" << perfEventName((PerfEvent)c) << "\": " << (uint64_t)t.counts[c];
+                }
+                out << ", \"ipc\": " << t.ipc() << "}";
+                first = false;
+            }
+        }
+    }
+    out << (first ? "]}\n" : "\n  ]}\n");
+    return out.str();
+}
+
+static std::string toJSON(const std::vector<BenchRecord>& records, uint32_t seed, const std::string& perf) {
+    std::ostringstream out;
+    out << "{\n  \"benchmark\": \"chess\",\n  \"seed\": " << seed << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < records.size(); i++) {
+        const BenchRecord& r = records[i];
+        out << "    {\"suite\": \"" << r.suite << "\", \"name\": \"" << r.name
+            << "\", \"piece\": \"" << r.piece << "\", \"board_size\": " << r.boardSize
+            << ", \"density\": " << r.density << ", \"queries\": " << r.queries
+            << ", \"ns_per_query\": " << r.nsPerQuery;
+        if (r.warmSeconds >= 0.0) out << ", \"warm_seconds\": " << r.warmSeconds;
+        else out << ", \"nodes_per_sec\": " << r.nodesPerSec;
+        out << ", \"allocs_per_query\": " << r.allocsPerQuery << ", \"alloc_bytes_per_query\": " << r.allocBytesPerQuery;
+        if (r.suite == "search") {
+            out << ", \"allocs_per_query_by_phase\": {";
+            for (int p = 0; p < PHASE_COUNT; p++) {
+                out << (p ? ", " : "") << "\"" << phaseName((SearchPhase)p) << "\": " << r.phaseAllocsPerQuery[p];
+            }
+            out << "}";
+        }
+        if (r.allocBudget >= 0.0) out << ", \"alloc_budget\": " << r.allocBudget;
+        if (r.suite == "search") {
+            out << ", \"latency_ns\": {\"p50\": " << r.latencyNs[0] << ", \"p99\": " << r.latencyNs[1]
+                << ", \"p99.9\": " << r.latencyNs[2] << ", \"max\": " << r.latencyNs[3] << "}";
+        }
+        out << ", \"state_bytes\": " << r.stateBytes << "}"
+            << (i + 1 < records.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n" << perf << "}\n";
+    return out.str();
+}
+
+int main(int argc, char** argv) {
+    bool quick = false;
+    bool perf = false;
+    std::string jsonPath, promPath;
+    uint32_t seed = 20240501;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--quick") == 0) quick = true;
+        else if (std::strcmp(argv[i], "--perf") == 0) perf = true;
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else if (std::strcmp(argv[i], "--prom") == 0 && i + 1 < argc) promPath = argv[++i];
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else {
+            std::cerr << "usage: " << argv[0] << " [--quick] [--json file] [--prom file] [--perf] [--seed N]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<BenchRecord> records;
+    std::printf("%-8s %-12s %-7s %4s %5s %8s %12s %14s %10s %10s %10s\n",
+                "suite", "name", "piece", "size", "dens", "queries", "ns/query", "nodes/s", "allocs/q", "allocB/q", "state_B");
+
+    uint64_t genIterations = quick ? 200000 : 2000000;
+    records.push_back(benchGenerator("knightMoves", KNIGHT_P, knightMoves, genIterations));
+    records.push_back(benchGenerator("kingMoves", KING_P, kingMoves, genIterations));
+    records.push_back(benchGenerator("rookMoves", ROOK_P, rookMoves, genIterations));
+    records.push_back(benchGenerator("bishopMoves", BISHOP_P, bishopMoves, genIterations));
+    records.push_back(benchGenerator("queenMoves", QUEEN_P, queenMoves, genIterations));
+
+    std::vector<int> sizes = quick ? std::vector<int>{8, 32} : std::vector<int>{8, 32, 128};
+    for (int size : sizes) benchTableInit(size, records);
+    for (const auto& r : records) printRecord(r);
+
+    // Search stats merged per engine and piece over all boards, for --prom
+    std::vector<LabeledStats> totals(ENGINE_COUNT * PIECE_COUNT);
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        for (int p = 0; p < PIECE_COUNT; p++) {
+            totals[e * PIECE_COUNT + p].labels = std::string("engine=\"") + engineName((EngineType)e)
+                                               + "\",piece=\"" + pieceName((PieceType)p) + "\"";
+        }
+    }
+
+    // Query latencies per engine and piece over all boards
+    std::vector<LatencyHistogram> latencies(ENGINE_COUNT * PIECE_COUNT);
+
+    // One profiler per engine so the counts can be told apart
+    std::vector<PhaseProfiler> profilers(perf ? ENGINE_COUNT : 0);
+    bool profiling = perf;
+    for (auto& prof : profilers) {
+        if (!prof.enable()) {
+            std::cerr << "perf counters unavailable, skipping --perf: " << prof.error() << std::endl;
+            profiling = false;
+            break;
+        }
+    }
+
+    std::vector<double> densities = {0.0, 0.15, 0.3};
+    for (int size : sizes) {
+        for (double density : densities) {
+            // Fewer queries on big boards so every configuration takes similar time
+            int queryCount = std::max(20, (quick ? 20000 : 200000) / (size * size));
+            uint32_t wseed = seed ^ (uint32_t)(size * 7919) ^ (uint32_t)(density * 1000);
+            Workload w = makeWorkload(size, density, queryCount, wseed);
+            for (int p = 0; p < PIECE_COUNT; p++) {
+                for (int e = 0; e < ENGINE_COUNT; e++) {
+                    auto engine = makeEngine((EngineType)e);
+                    records.push_back(benchSearch(*engine, (PieceType)p, w, density, totals[e * PIECE_COUNT + p],
+                                                  latencies[e * PIECE_COUNT + p]));
+                    printRecord(records.back());
+                    if (profiling) profileSearch(*engine, profilers[e], (PieceType)p, w);
+                }
+            }
+        }
+    }
+
+    std::cout << "\nquery latency over all boards\n";
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        for (int p = 0; p < PIECE_COUNT; p++) {
+            writeLatencyLine(std::cout, std::string(engineName((EngineType)e)) + "/" + pieceName((PieceType)p),
+                             latencies[e * PIECE_COUNT + p]);
+        }
+    }
+
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        if (!out) {
+            std::cerr << "Failed to write " << jsonPath << std::endl;
+            return 1;
+        }
+        out << toJSON(records, seed, perfJSON(perf, profilers));
+        std::cout << "wrote " << jsonPath << std::endl;
+    }
+    if (!promPath.empty()) {
+        if (!writePrometheus(promPath, totals)) return 1;
+        std::cout << "wrote " << promPath << std::endl;
+    }
+
+    int overBudget = 0;
+    for (const auto& r : records) {
+        if (!r.overBudget()) continue;
+        std::cerr << "ALLOCATION REGRESSION: " << r.name << " " << r.piece << " on " << r.boardSize << "x" << r.boardSize
+                  << " (density " << r.density << ") made " << r.allocsPerQuery << " allocations/query, budget "
+                  << r.allocBudget << std::endl;
+        overBudget++;
+    }
+    if (overBudget) return 3;
+    return 0;
+}
@@ -1,4 +1,6 @@
 // main.cpp
+#define GL_GLEXT_PROTOTYPES // PBO functions for the frame recorder
+#define GLFW_INCLUDE_GLEXT
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <vector>
@@ -10,10 +12,16 @@
 #include <chrono>
 #include <functional>
 #include <string>
+#include <cstring>
+
+#include "chess_moves.h"
+#include "chess_search.h"
+#include "search_stats.h"
+#include "trace.h"
+#include "frame_recorder.h"
 
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 640;
-const int BOARD_SIZE = 8;
 const int SQUARE_SIZE = SCREEN_WIDTH / BOARD_SIZE;
 const float PI = 3.14159265359f;
 
@@ -32,91 +40,6 @@ const Color GREEN_PATH = {50/255.0f, 205/255.0f, 50/255.0f};
 const Color RED_GOAL = {220/255.0f, 20/255.0f, 60/255.0f};
 const Color EDGE_COLOR = {50/255.0f, 50/255.0f, 50/255.0f};
 
-// Point Helper
-struct Point {
-    int x, y;
-    bool operator<(const Point& other) const {
-        if (x != other.x) return x < other.x;
-        return y < other.y;
-    }
-    bool operator==(const Point& other) const {
-        return x == other.x && y == other.y;
-    }
-    bool operator!=(const Point& other) const {
-        return !(*this == other);
-    }
-};
-
-enum PieceType { KNIGHT_P, KING_P, ROOK_P, BISHOP_P, QUEEN_P };
-
-// Pre-declared movement function type
-using MoveFunc = std::function<std::vector<Point>(const Point&)>;
-
-// Knight Moves (unchanged)
-const std::vector<Point> KNIGHT_MOVES = {
-    {2, 1}, {2, -1}, {-2, 1}, {-2, -1},
-    {1, 2}, {1, -2}, {-1, 2}, {-1, -2}
-};
-
-// --- Movement functions for all pieces ---
-
-std::vector<Point> knightMoves(const Point& p) {
-    std::vector<Point> out;
-    for (const auto &m : KNIGHT_MOVES) {
-        Point n = {p.x + m.x, p.y + m.y};
-        if (n.x >= 0 && n.x < BOARD_SIZE && n.y >= 0 && n.y < BOARD_SIZE) out.push_back(n);
-    }
-    return out;
-}
-
-std::vector<Point> kingMoves(const Point& p) {
-    std::vector<Point> out;
-    for (int dx = -1; dx <= 1; dx++) {
-        for (int dy = -1; dy <= 1; dy++) {
-            if (dx == 0 && dy == 0) continue;
-            Point n = {p.x + dx, p.y + dy};
-            if (n.x >= 0 && n.x < BOARD_SIZE && n.y >= 0 && n.y < BOARD_SIZE) out.push_back(n);
-        }
-    }
-    return out;
-}
-
-// sliding helper: iterate in direction until edge
-std::vector<Point> slidingMoves(const Point& p, const std::vector<std::pair<int,int>>& dirs) {
-    std::vector<Point> out;
-    for (auto d : dirs) {
-        int dx = d.first, dy = d.second;
-        int nx = p.x + dx, ny = p.y + dy;
-        while (nx >= 0 && nx < BOARD_SIZE && ny >= 0 && ny < BOARD_SIZE) {
-            out.push_back({nx, ny});
-            nx += dx; ny += dy;
-        }
-    }
-    return out;
-}
-
-std::vector<Point> rookMoves(const Point& p) {
-    static const std::vector<std::pair<int,int>> dirs = {
-        {1,0},{-1,0},{0,1},{0,-1}
-    };
-    return slidingMoves(p, dirs);
-}
-
-std::vector<Point> bishopMoves(const Point& p) {
-    static const std::vector<std::pair<int,int>> dirs = {
-        {1,1},{1,-1},{-1,1},{-1,-1}
-    };
-    return slidingMoves(p, dirs);
-}
-
-std::vector<Point> queenMoves(const Point& p) {
-    static const std::vector<std::pair<int,int>> dirs = {
-        {1,0},{-1,0},{0,1},{0,-1},
-        {1,1},{1,-1},{-1,1},{-1,-1}
-    };
-    return slidingMoves(p, dirs);
-}
-
 // --- Visualizer class (adapted) ---
 class KnightBFSVisualizer {
 private:
@@ -147,10 +70,17 @@ private:
     // Timing
     double lastBFSStepTime = 0.0;
 
+    // Search counters, shown in the window title
+    SearchStats stats;
+    LevelCounter levelCounter;
+
     // Piece selection
     PieceType currentPiece = KNIGHT_P;
     MoveFunc movementFunction = knightMoves;
 
+    // Optional recording of every frame
+    FrameRecorder recorder;
+
 public:
 
     KnightBFSVisualizer() {
@@ -182,10 +112,17 @@ public:
     }
 
     ~KnightBFSVisualizer() {
+        recorder.stop(); // needs the GL context, so before the window goes
         glfwDestroyWindow(window);
         glfwTerminate();
     }
 
+    bool startRecording(const std::string& path, CaptureFormat format) {
+        int fbWidth, fbHeight; // differs from the window size on retina screens
+        glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+        return recorder.start(path, format, fbWidth, fbHeight);
+    }
+
     void reset() {
         hasStart = false;
         hasGoal = false;
@@ -203,6 +140,8 @@ public:
         animProgress = 0.0f;
         renderX = -100.0f;
         currentNode = {-1,-1};
+        stats = SearchStats();
+        updateHud();
     }
 
     void setPiece(PieceType p) {
@@ -230,49 +169,92 @@ public:
         parents[startPos] = {-1, -1};
         currentNode = {-1,-1};
         lastBFSStepTime = glfwGetTime();
+        stats = SearchStats();
+        levelCounter = LevelCounter();
     }
 
     void stepBFS() {
-        if (queue.empty()) {
-            runningBFS = false;
-            return;
-        }
-
-        Point current = queue.front();
-        queue.pop_front();
-        currentNode = current;
+        {
+            // The zone closes before the pacing sleep below
+            TRACE_SCOPE("stepBFS");
+            if (queue.empty()) {
+                runningBFS = false;
+                updateHud();
+                return;
+            }
 
-        if (current == goalPos) {
-            reconstructPath();
-            runningBFS = false;
-            pathFound = true;
-            animatingPath = true;
-            animIndex = 0;
-            animProgress = 0.0f;
-            // Place render at start of path
-            if (!shortestPath.empty()) {
-                renderX = shortestPath[0].x * SQUARE_SIZE;
-                renderY = shortestPath[0].y * SQUARE_SIZE;
+            PhaseClock clock;
+            Point current = queue.front();
+            queue.pop_front();
+            currentNode = current;
+            stats.nodesPopped++;
+            levelCounter.popped(stats);
+
+            if (current == goalPos) {
+                clock.lap(stats, PHASE_EXPAND);
+                reconstructPath();
+                clock.lap(stats, PHASE_RECONSTRUCT);
+                runningBFS = false;
+                pathFound = true;
+                animatingPath = true;
+                animIndex = 0;
+                animProgress = 0.0f;
+                // Place render at start of path
+                if (!shortestPath.empty()) {
+                    renderX = shortestPath[0].x * SQUARE_SIZE;
+                    renderY = shortestPath[0].y * SQUARE_SIZE;
+                }
+                updateHud();
+                return;
             }
-            return;
-        }
-        // visited.insert(current);
-        // Generate neighbors using selected movement function
-        std::vector<Point> neighbors = movementFunction(current);
-        for (const auto& neighbor : neighbors) {
-            if (visited.find(neighbor) == visited.end()) {
-                visited.insert(neighbor);
-                parents[neighbor] = current;
-                queue.push_back(neighbor);
-                edgesExplored.push_back({current, neighbor});
+            // visited.insert(current);
+            // Generate neighbors using selected movement function
+            std::vector<Point> neighbors = movementFunction(current);
+            stats.neighborsGenerated += neighbors.size();
+            for (const auto& neighbor : neighbors) {
+                if (visited.find(neighbor) == visited.end()) {
+                    visited.insert(neighbor);
+                    parents[neighbor] = current;
+                    queue.push_back(neighbor);
+                    edgesExplored.push_back({current, neighbor});
+                    levelCounter.pushed();
+                } else {
+                    stats.duplicatesRejected++;
+                }
             }
+            if (queue.size() > stats.maxFrontier) stats.maxFrontier = queue.size();
+            clock.lap(stats, PHASE_EXPAND);
+            updateHud();
         }
 
         // optional little sleep to visually pace the BFS
         std::this_thread::sleep_for(std::chrono::milliseconds(60));
     }
 
+    // The window title doubles as a HUD for the search counters
+    void updateHud() {
+        size_t stateBytes = visited.size() * (TREE_NODE_OVERHEAD + sizeof(Point))
+                          + parents.size() * (TREE_NODE_OVERHEAD + 2 * sizeof(Point))
+                          + queue.size() * sizeof(Point)
+                          + edgesExplored.capacity() * sizeof(std::pair<Point, Point>);
+        if (stateBytes > stats.peakStateBytes) stats.peakStateBytes = stateBytes;
+
+        std::string title = "Chess-Piece BFS Visualizer - C++ OpenGL";
+        if (stats.nodesPopped > 0) {
+            char hud[200];
+            std::snprintf(hud, sizeof(hud), " | %s: popped %llu, generated %llu, dup %llu, frontier %llu, levels %llu, %.1f KB, expand %.0f us",
+                          pieceName(currentPiece),
+                          (unsigned long long)stats.nodesPopped, (unsigned long long)stats.neighborsGenerated,
+                          (unsigned long long)stats.duplicatesRejected, (unsigned long long)stats.maxFrontier,
+                          (unsigned long long)stats.levels, stats.peakStateBytes / 1024.0,
+                          stats.phaseSeconds[PHASE_EXPAND] * 1e6);
+            title += hud;
+        }
+        glfwSetWindowTitle(window, title.c_str());
+    }
+
     void reconstructPath() {
+        TRACE_SCOPE("reconstructPath");
         Point curr = goalPos;
         std::vector<Point> tempPath;
         while (curr.x != -1) { // While not null parent
@@ -287,6 +269,7 @@ public:
     }
 
     void updateAnimation() {
+        TRACE_SCOPE("updateAnimation");
         if (shortestPath.empty()) return;
         if (animIndex >= shortestPath.size() - 1) {
             // finished
@@ -413,6 +396,7 @@ public:
     }
 
     void draw() {
+        TRACE_SCOPE("draw");
         glClear(GL_COLOR_BUFFER_BIT);
 
         // 1. Draw Board
@@ -475,7 +459,7 @@ public:
             drawPieceSymbol(rp, currentPiece, renderX, renderY);
         }
 
-
+        recorder.captureFrame();
         glfwSwapBuffers(window);
     }
 
@@ -557,8 +541,26 @@ public:
     }
 };
 
-int main() {
+int main(int argc, char** argv) {
     KnightBFSVisualizer app;
+
+    // --record <file|folder> [--record-format raw|png] [--trace trace.json]
+    std::string recordPath;
+    CaptureFormat recordFormat = CAPTURE_RAW;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--record-format") == 0 && i + 1 < argc) {
+            recordFormat = std::strcmp(argv[++i], "png") == 0 ? CAPTURE_PNG : CAPTURE_RAW;
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            traceStart(argv[++i]);
+            traceThreadName("main");
+        }
+    }
+    if (!recordPath.empty() && !app.startRecording(recordPath, recordFormat)) {
+        std::cerr << "Recording disabled" << std::endl;
+    }
+
     // default piece is knight - it's already set
     app.run();
     return 0;
@@ -8,6 +8,12 @@ import math
 import time
 import sys
 
+# Optional native engines (see native_module.cpp); the N key uses them
+try:
+    import bfs_native
+except ImportError:
+    bfs_native = None
+
 # --- Constants ---
 SCREEN_WIDTH = 640
 SCREEN_HEIGHT = 640
@@ -238,6 +244,20 @@ class BFSVisualizer:
                 self.queue.append(neighbor)
                 self.edges_explored.append((current, neighbor))
 
+    def solve_native(self):
+        """Finds the path with the native engine and animates it right away."""
+        start = (self.start_pos.x, self.start_pos.y)
+        goal = (self.goal_pos.x, self.goal_pos.y)
+        distance, path = bfs_native.search(self.current_piece, start, goal, BOARD_SIZE)
+        if distance < 0:
+            return
+        self.shortest_path = [Point(x, y) for x, y in path.tolist()]
+        self.path_found = True
+        self.animating_path = True
+        self.anim_index = 0
+        self.anim_progress = 0.0
+        self.render_pos = self.get_square_coords(self.shortest_path[0])
+
     def reconstruct_path(self):
         """Backtracks from goal to start using the parents map."""
         curr = self.goal_pos
@@ -406,6 +426,9 @@ class BFSVisualizer:
         if key == pygame.K_SPACE:
             if self.start_pos and self.goal_pos and not self.running_bfs and not self.path_found:
                 self.start_bfs()
+        elif key == pygame.K_n and bfs_native:
+            if self.start_pos and self.goal_pos and not self.running_bfs and not self.path_found:
+                self.solve_native()
         elif key == pygame.K_r:
             self.reset_state()
         elif pygame.K_1 <= key <= pygame.K_5:
@@ -0,0 +1,89 @@
+// board_graph.h
+// Exports the implicit move graph of one piece on a Board to a CSR graph,
+// so the generic BFS of csr_bfs.h (or anything else that takes a CSR graph)
+// runs on chess boards.
+//
+// Vertex ids are square indices, y * size + x. Every square, blocked or not,
+// gets arcs to the free squares its piece reaches in generateMoves() order
+// (a search may start on a blocked square; it can never enter one). With
+// weights, each arc carries the number of squares the move travels
+// (Chebyshev distance: 1 for the king, 2 for the knight, k for a k-square
+// slide).
+//
+// squareOrder() numbers the squares along a space-filling curve instead of
+// row by row (Morton / Z-order or Hilbert), for permuteCsr() in
+// graph_reorder.h: a piece's moves from a square then mostly land on nearby
+// ids, in every direction rather than only along the row.
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+#include "chess_moves.h"
+#include "csr_graph.h"
+#include "graph_reorder.h"
+
+inline CompactCsrGraph boardGraph(const Board& board, PieceType piece, bool withWeights = false) {
+    CompactCsrGraph g;
+    g.n = (uint32_t)board.cells();
+    g.offsets.assign(g.n + 1, 0);
+    std::vector<Point> moves;
+    for (uint32_t s = 0; s < g.n; s++) {
+        Point p = board.point((int)s);
+        moves.clear();
+        generateMoves(board, piece, p, moves);
+        for (const Point& m : moves) {
+            g.targets.push_back((uint32_t)board.index(m));
+            if (withWeights) g.weights.push_back((uint32_t)std::max(std::abs(m.x - p.x), std::abs(m.y - p.y)));
+        }
+        g.offsets[s + 1] = (uint32_t)g.targets.size();
+    }
+    return g;
+}
+
+enum SquareCurve { SQUARES_ROWS, SQUARES_MORTON, SQUARES_HILBERT };
+
+// Position of (x, y) on the Z-order curve: the bits of x and y interleaved
+inline uint64_t mortonIndex(uint32_t x, uint32_t y) {
+    uint64_t key = 0;
+    for (int b = 0; b < 32; b++) key |= (uint64_t)(x >> b & 1) << (2 * b) | (uint64_t)(y >> b & 1) << (2 * b + 1);
+    return key;
+}
+
+// Position of (x, y) on the Hilbert curve filling a side x side square (side a power of two)
+inline uint64_t hilbertIndex(uint32_t side, uint32_t x, uint32_t y) {
+    uint64_t d = 0;
+    for (uint32_t s = side / 2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) ? 1 : 0, ry = (y & s) ? 1 : 0;
+        d += (uint64_t)s * s * ((3 * rx) ^ ry);
+        // Rotate the quadrant so the curve inside it starts at its corner
+        if (ry == 0) {
+            if (rx == 1) {
+                x = side - 1 - x;
+                y = side - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+// Squares of the board (ids y * size + x) in curve order; boards that are
+// not a power of two wide follow the curve of the next power of two
+inline VertexPermutation squareOrder(const Board& board, SquareCurve curve) {
+    uint32_t cells = (uint32_t)board.cells();
+    if (curve == SQUARES_ROWS) return VertexPermutation::identity(cells);
+    uint32_t side = 1;
+    while (side < (uint32_t)board.size) side *= 2;
+    std::vector<uint64_t> key(cells);
+    for (uint32_t s = 0; s < cells; s++) {
+        Point p = board.point((int)s);
+        key[s] = curve == SQUARES_MORTON ? mortonIndex(p.x, p.y) : hilbertIndex(side, p.x, p.y);
+    }
+    std::vector<uint32_t> order(cells);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return key[a] < key[b]; });
+    return VertexPermutation::fromOrder(std::move(order));
+}
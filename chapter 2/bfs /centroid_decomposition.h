@@ -0,0 +1,383 @@
+// centroid_decomposition.h
+// Centroid decomposition of a static tree (or forest) stored as an
+// undirected CsrGraph, for distance aggregates: nearest marked vertex with
+// marks added and removed online, and the number of vertex pairs within
+// distance k.
+//
+// Removing a centroid (a vertex whose removal leaves pieces of at most half
+// the size) and recursing on the pieces gives every vertex as the centroid
+// of exactly one piece, at a level <= log2(n). A vertex v lies in the
+// pieces of its centroid-tree ancestors only, so any path u..v passes
+// through their deepest common ancestor, and per-vertex distances to those
+// ancestors answer the queries.
+//
+// The build is iterative (no recursion, any depth is fine):
+//   0. copy the tree with vertices renumbered in DFS discovery order, which
+//      keeps most pieces in nearby memory (about 3x faster on random trees)
+//   1. split pieces with a work stack, one BFS per piece to find its centroid
+//   2. level by level, in parallel over the centroids of the level, a BFS
+//      from each centroid over its piece fills the distance arrays and the
+//      piece's histograms of distances to the centroid and to its parent
+// Distances are stored packed: vertex v keeps exactly level(v) + 1 values,
+// top level first. The histograms (prefix counts, one entry per distance)
+// make pair counting O(sum of piece radii) per k, with no per-pair work.
+//
+// Nearest-marked keeps a min-heap per centroid of (distance, marked vertex)
+// over its piece. unmark() only clears a flag; stale heap tops are popped by
+// the next query that meets them. Each heap also counts the marked vertices
+// of its piece, and one that grows past twice that (stale entries, or a
+// vertex marked again while its old entry is still there) is rebuilt from
+// its live entries, so under any churn the heaps hold O(live marks) entries.
+// The rebuild's sort is paid for by the entries it drops, so mark and
+// nearestMarked stay O(log^2 n) amortized and unmark O(log n).
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "csr_graph.h"
+#include "thread_pool.h"
+
+struct NearestMarked {
+    uint32_t distance = NO_VERTEX; // NO_VERTEX when nothing marked is reachable
+    uint32_t vertex = NO_VERTEX;
+};
+
+class CentroidIndex {
+public:
+    CentroidIndex(const CsrGraph& g, ThreadPool& pool) : pool(pool), n(g.n) {
+        auto started = std::chrono::steady_clock::now();
+        renumber(g);
+        decompose();
+        measurePieces();
+        buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+
+    uint32_t levels() const { return (uint32_t)byLevel.size(); }
+    uint32_t levelOf(uint32_t v) const { return level[toInner[v]]; }
+    double buildTime() const { return buildSeconds; }
+
+    // The centroid whose piece v's piece was split from, NO_VERTEX at the top
+    uint32_t parentCentroid(uint32_t v) const {
+        uint32_t p = up[toInner[v]];
+        return p == NO_VERTEX ? NO_VERTEX : toOuter[p];
+    }
+
+    size_t bytes() const {
+        return t.bytes() + (toInner.size() + toOuter.size() + level.size() + up.size()) * sizeof(uint32_t)
+             + (distStart.size() + histStart.size() + upHistStart.size()) * sizeof(uint64_t)
+             + (dist.size() + hist.size() + upHist.size()) * sizeof(uint32_t);
+    }
+
+    // Edges between u and v through their deepest common centroid, NO_VERTEX
+    // across components; O(log n)
+    uint32_t distance(uint32_t u, uint32_t v) const {
+        u = toInner[u];
+        v = toInner[v];
+        uint32_t a = u, b = v;
+        while (level[a] > level[b]) a = up[a];
+        while (level[b] > level[a]) b = up[b];
+        while (a != b) {
+            if (up[a] == NO_VERTEX) return NO_VERTEX;
+            a = up[a];
+            b = up[b];
+        }
+        return distTo(u, level[a]) + distTo(v, level[a]);
+    }
+
+    void mark(uint32_t v) {
+        if (heaps.empty()) {
+            heaps.resize(n);
+            live.assign(n, 0);
+            marked.assign(n, false);
+        }
+        v = toInner[v];
+        if (marked[v]) return;
+        marked[v] = true;
+        for (uint32_t c = v; c != NO_VERTEX; c = up[c]) {
+            live[c]++;
+            heaps[c].push_back({distTo(v, level[c]), v});
+            std::push_heap(heaps[c].begin(), heaps[c].end(), std::greater<Entry>());
+            compactIfStale(c);
+        }
+    }
+
+    void unmark(uint32_t v) {
+        if (marked.empty()) return;
+        v = toInner[v];
+        if (!marked[v]) return;
+        marked[v] = false;
+        for (uint32_t c = v; c != NO_VERTEX; c = up[c]) {
+            live[c]--;
+            compactIfStale(c);
+        }
+    }
+
+    // Entries held by the nearest-marked heaps, live and stale
+    uint64_t heapEntries() const {
+        uint64_t total = 0;
+        for (const auto& heap : heaps) total += heap.size();
+        return total;
+    }
+
+    bool isMarked(uint32_t v) const { return !marked.empty() && marked[toInner[v]]; }
+
+    // A closest marked vertex to v; pops stale heap entries on the way
+    NearestMarked nearestMarked(uint32_t v) {
+        NearestMarked best;
+        if (heaps.empty()) return best;
+        v = toInner[v];
+        for (uint32_t c = v; c != NO_VERTEX; c = up[c]) {
+            auto& heap = heaps[c];
+            while (!heap.empty() && !marked[heap.front().second]) {
+                std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+                heap.pop_back();
+            }
+            if (heap.empty()) continue;
+            uint32_t d = heap.front().first + distTo(v, level[c]);
+            if (d < best.distance) best = {d, heap.front().second};
+        }
+        if (best.vertex != NO_VERTEX) best.vertex = toOuter[best.vertex];
+        return best;
+    }
+
+    // Unordered pairs {u, v}, u != v, with distance(u, v) <= k
+    uint64_t pairsWithin(uint32_t k) const {
+        // Per centroid: ordered pairs of its piece with d(u, c) + d(v, c) <= k,
+        // minus those inside one child piece (measured the same way), which
+        // leaves the pairs whose path runs through c, plus (c, c) itself
+        uint64_t ordered = 0;
+        for (uint32_t c = 0; c < n; c++) {
+            ordered += orderedPairs(hist, histStart[c], histStart[c + 1], k);
+            ordered -= orderedPairs(upHist, upHistStart[c], upHistStart[c + 1], k);
+        }
+        return (ordered - n) / 2;
+    }
+
+private:
+    using Entry = std::pair<uint32_t, uint32_t>; // distance, vertex
+
+    uint32_t distTo(uint32_t v, uint32_t l) const { return dist[distStart[v] + l]; }
+
+    // Rebuilds c's heap from its live entries once it holds more than twice
+    // as many; the entries a rebuild drops paid for it
+    void compactIfStale(uint32_t c) {
+        auto& heap = heaps[c];
+        if (heap.size() <= 2 * (size_t)live[c] + HEAP_SLACK) return;
+        heap.erase(std::remove_if(heap.begin(), heap.end(), [&](const Entry& e) { return !marked[e.second]; }),
+                   heap.end());
+        // A vertex marked twice has two equal entries; sorted ascending is a min-heap
+        std::sort(heap.begin(), heap.end());
+        heap.erase(std::unique(heap.begin(), heap.end()), heap.end());
+        if (heap.capacity() > 2 * heap.size() + HEAP_SLACK) heap.shrink_to_fit();
+    }
+
+    // Pairs (a, b) of a prefix-count histogram with a + b <= k
+    static uint64_t orderedPairs(const std::vector<uint32_t>& prefix, uint64_t begin, uint64_t end, uint32_t k) {
+        uint64_t len = end - begin, total = 0;
+        for (uint64_t a = 0; a < len && a <= k; a++) {
+            uint64_t here = prefix[begin + a] - (a ? prefix[begin + a - 1] : 0);
+            if (here == 0) continue;
+            uint64_t b = std::min<uint64_t>(k - a, len - 1);
+            total += here * prefix[begin + b];
+        }
+        return total;
+    }
+
+    // Step 0: a private copy of the graph numbered in DFS discovery order
+    // (the children of a vertex get consecutive ids), so pieces, which are
+    // connected, mostly sit in nearby memory
+    void renumber(const CsrGraph& g) {
+        toInner.assign(g.n, NO_VERTEX);
+        toOuter.resize(g.n);
+        std::vector<uint32_t> stack;
+        uint32_t next = 0;
+        for (uint32_t root = 0; root < g.n; root++) {
+            if (toInner[root] != NO_VERTEX) continue;
+            toInner[root] = next;
+            toOuter[next++] = root;
+            stack.push_back(root);
+            while (!stack.empty()) {
+                uint32_t u = stack.back();
+                stack.pop_back();
+                for (const uint32_t* it = g.begin(u); it != g.end(u); ++it) {
+                    if (toInner[*it] != NO_VERTEX) continue;
+                    toInner[*it] = next;
+                    toOuter[next++] = *it;
+                    stack.push_back(*it);
+                }
+            }
+        }
+        t.n = g.n;
+        t.offsets.assign(g.n + 1, 0);
+        for (uint32_t v = 0; v < g.n; v++) t.offsets[v + 1] = t.offsets[v] + g.degree(toOuter[v]);
+        t.targets.resize(g.arcs());
+        pool.parallelFor(g.n, 4096, [&](size_t b, size_t e, int) {
+            for (size_t v = b; v < e; v++) {
+                uint32_t* out = t.targets.data() + t.offsets[v];
+                for (const uint32_t* it = g.begin(toOuter[v]); it != g.end(toOuter[v]); ++it) *out++ = toInner[*it];
+            }
+        });
+    }
+
+    // Step 1: the centroid tree (up, level) and the centroids of each level
+    void decompose() {
+        const uint32_t NONE = NO_VERTEX;
+        level.assign(n, NONE);
+        up.assign(n, NONE);
+        std::vector<uint32_t> order(n), from(n), size(n), heavy(n), visited(n, NONE);
+        struct Piece {
+            uint32_t start, parent, level;
+        };
+        std::vector<Piece> pieces;
+        uint32_t stamp = 0;
+        for (uint32_t root = 0; root < n; root++) {
+            if (level[root] != NONE) continue;
+            pieces.push_back({root, NONE, 0});
+            while (!pieces.empty()) {
+                Piece p = pieces.back();
+                pieces.pop_back();
+                if (level[p.start] != NONE) continue; // only with cycles in the input
+
+                // BFS over the vertices not yet taken as centroids
+                uint32_t m = 0;
+                order[m++] = p.start;
+                from[p.start] = NONE;
+                visited[p.start] = stamp;
+                for (uint32_t head = 0; head < m; head++) {
+                    uint32_t u = order[head];
+                    size[u] = 1;
+                    heavy[u] = 0;
+                    for (const uint32_t* it = t.begin(u); it != t.end(u); ++it) {
+                        if (level[*it] != NONE || visited[*it] == stamp) continue;
+                        visited[*it] = stamp;
+                        from[*it] = u;
+                        order[m++] = *it;
+                    }
+                }
+                stamp++;
+                for (uint32_t i = m; i-- > 1;) {
+                    uint32_t v = order[i], parent = from[v];
+                    size[parent] += size[v];
+                    heavy[parent] = std::max(heavy[parent], size[v]);
+                }
+                uint32_t c = p.start;
+                for (uint32_t i = 0; i < m; i++) {
+                    uint32_t v = order[i];
+                    if (std::max(heavy[v], m - size[v]) <= m / 2) {
+                        c = v;
+                        break;
+                    }
+                }
+
+                level[c] = p.level;
+                up[c] = p.parent;
+                if (byLevel.size() <= p.level) byLevel.resize(p.level + 1);
+                byLevel[p.level].push_back(c);
+                for (const uint32_t* it = t.begin(c); it != t.end(c); ++it) {
+                    if (level[*it] == NONE) pieces.push_back({*it, c, p.level + 1});
+                }
+            }
+        }
+    }
+
+    // Per-worker state of step 2. Histograms are appended to `out` in the
+    // order of `done` and copied to their final place at the end.
+    struct Worker {
+        std::vector<std::pair<uint32_t, uint32_t>> queue; // vertex, distance
+        std::vector<uint32_t> out;
+        std::vector<uint32_t> done;
+    };
+
+    // Appends a prefix-count histogram of values[0 .. count) to out
+    template <typename Value>
+    static uint32_t appendHistogram(std::vector<uint32_t>& out, size_t count, Value value) {
+        uint32_t top = 0;
+        for (size_t i = 0; i < count; i++) top = std::max(top, value(i));
+        size_t at = out.size();
+        out.resize(at + top + 1, 0);
+        for (size_t i = 0; i < count; i++) out[at + value(i)]++;
+        for (size_t j = at + 1; j < out.size(); j++) out[j] += out[j - 1];
+        return top + 1;
+    }
+
+    // Step 2, level by level and in parallel over each level's centroids: a
+    // BFS from the centroid over its piece (itself and the vertices of deeper
+    // levels it reaches) stores every member's distance to it, and the
+    // piece's histograms of distances to the centroid and to its parent
+    // centroid (known from the previous level). seen[] is shared: the pieces
+    // of one level are disjoint.
+    void measurePieces() {
+        distStart.assign(n + 1, 0);
+        for (uint32_t v = 0; v < n; v++) distStart[v + 1] = distStart[v] + level[v] + 1;
+        dist.resize(distStart[n]);
+        std::vector<uint32_t> seen(n, NO_VERTEX), histLength(n), upLength(n, 0);
+        std::vector<Worker> workers(pool.size());
+        for (uint32_t l = 0; l < levels(); l++) {
+            const auto& centroids = byLevel[l];
+            pool.parallelFor(centroids.size(), 1, [&](size_t b, size_t e, int tid) {
+                Worker& w = workers[tid];
+                auto& queue = w.queue;
+                for (size_t i = b; i < e; i++) {
+                    uint32_t c = centroids[i];
+                    queue.assign(1, {c, 0});
+                    seen[c] = l;
+                    for (size_t head = 0; head < queue.size(); head++) {
+                        uint32_t u = queue[head].first, d = queue[head].second;
+                        dist[distStart[u] + l] = d;
+                        for (const uint32_t* it = t.begin(u); it != t.end(u); ++it) {
+                            if (level[*it] <= l || seen[*it] == l) continue;
+                            seen[*it] = l;
+                            queue.push_back({*it, d + 1});
+                        }
+                    }
+                    histLength[c] = appendHistogram(w.out, queue.size(), [&](size_t k) { return queue[k].second; });
+                    if (l > 0) {
+                        upLength[c] = appendHistogram(w.out, queue.size(),
+                                                      [&](size_t k) { return distTo(queue[k].first, l - 1); });
+                    }
+                    w.done.push_back(c);
+                }
+            });
+        }
+
+        histStart.assign(n + 1, 0);
+        upHistStart.assign(n + 1, 0);
+        for (uint32_t c = 0; c < n; c++) {
+            histStart[c + 1] = histStart[c] + histLength[c];
+            upHistStart[c + 1] = upHistStart[c] + upLength[c];
+        }
+        hist.resize(histStart[n]);
+        upHist.resize(upHistStart[n]);
+        pool.run([&](int tid) {
+            const Worker& w = workers[tid];
+            const uint32_t* from = w.out.data();
+            for (uint32_t c : w.done) {
+                std::copy(from, from + histLength[c], hist.begin() + histStart[c]);
+                from += histLength[c];
+                std::copy(from, from + upLength[c], upHist.begin() + upHistStart[c]);
+                from += upLength[c];
+            }
+        });
+    }
+
+    ThreadPool& pool;
+    uint32_t n;
+    CsrGraph t;                                  // the tree in inner ids
+    std::vector<uint32_t> toInner, toOuter;
+    std::vector<uint32_t> level;                 // centroid level of every vertex
+    std::vector<uint32_t> up;                    // parent in the centroid tree
+    std::vector<std::vector<uint32_t>> byLevel;  // centroids of each level
+    std::vector<uint64_t> distStart;
+    std::vector<uint32_t> dist;                  // packed, level(v) + 1 per vertex
+    std::vector<uint64_t> histStart, upHistStart;
+    std::vector<uint32_t> hist, upHist;          // prefix counts by distance
+    static const size_t HEAP_SLACK = 8;          // stale entries a small heap may keep
+    std::vector<std::vector<Entry>> heaps;       // allocated by the first mark()
+    std::vector<uint32_t> live;                  // marked vertices per piece
+    std::vector<bool> marked;
+    double buildSeconds = 0.0;
+};
@@ -0,0 +1,156 @@
+// chess_batch.h
+// Runs many searches on one board with a pool of worker threads.
+// Every worker owns its engine, so engines never share state; queries are
+// handed out in small chunks through one atomic counter.
+//
+// With BatchOptions::latencies set, every query's wall time goes into a
+// per-worker, per-piece latency histogram; they are merged into *latencies
+// after the workers finish. dumpEverySeconds/dumpTo additionally print a
+// merged snapshot periodically while the batch runs. Neither takes a lock on
+// the query path.
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chess_search.h"
+#include "latency_histogram.h"
+#include "search_stats.h"
+#include "trace.h"
+
+struct BatchQuery {
+    PieceType piece;
+    Point start;
+    Point goal;
+};
+
+struct BatchResult {
+    int distance = -1;
+    std::vector<Point> path; // only filled with BatchOptions::keepPaths
+    SearchStats stats;
+};
+
+// Query latencies in nanoseconds, one histogram per piece
+struct BatchLatencies {
+    LatencyHistogram byPiece[PIECE_COUNT];
+
+    void merge(const BatchLatencies& o) {
+        for (int p = 0; p < PIECE_COUNT; p++) byPiece[p].merge(o.byPiece[p]);
+    }
+
+    void write(std::ostream& out, const std::string& engine) const {
+        for (int p = 0; p < PIECE_COUNT; p++) {
+            if (byPiece[p].count()) writeLatencyLine(out, engine + "/" + pieceName((PieceType)p), byPiece[p]);
+        }
+    }
+};
+
+struct BatchOptions {
+    EngineType engine = ENGINE_ARRAY;
+    int threads = 0;        // 0 = one per hardware thread
+    bool keepPaths = false;
+    BatchLatencies* latencies = nullptr; // per-query latencies are added here
+    double dumpEverySeconds = 0.0;       // > 0 with dumpTo: periodic snapshots
+    std::ostream* dumpTo = nullptr;
+};
+
+const size_t BATCH_CHUNK = 64;
+
+inline std::vector<BatchResult> runBatch(const Board& board, const std::vector<BatchQuery>& queries,
+                                         const BatchOptions& options = BatchOptions()) {
+    std::vector<BatchResult> results(queries.size());
+    int threads = options.threads > 0 ? options.threads : (int)std::thread::hardware_concurrency();
+    threads = std::max(1, std::min<int>(threads, (int)((queries.size() + BATCH_CHUNK - 1) / BATCH_CHUNK)));
+    std::atomic<size_t> next{0};
+    bool timed = options.latencies != nullptr;
+    std::vector<BatchLatencies> workerLatencies(timed ? threads : 0);
+
+    auto worker = [&](int id) {
+        TRACE_SCOPE("batch worker");
+        auto engine = makeEngine(options.engine);
+        while (true) {
+            size_t begin = next.fetch_add(BATCH_CHUNK);
+            if (begin >= queries.size()) break;
+            TRACE_SCOPE("batch chunk");
+            size_t end = std::min(queries.size(), begin + BATCH_CHUNK);
+            for (size_t i = begin; i < end; i++) {
+                const BatchQuery& q = queries[i];
+                auto t0 = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+                SearchResult res = engine->search(board, q.piece, q.start, q.goal);
+                if (timed) {
+                    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+                    workerLatencies[id].byPiece[q.piece].record((uint64_t)ns);
+                }
+                results[i].distance = res.distance;
+                results[i].stats = res.stats;
+                if (options.keepPaths) results[i].path = std::move(res.path);
+            }
+        }
+    };
+
+    // Periodic snapshots read the workers' histograms without stopping them
+    std::mutex dumpMutex;
+    std::condition_variable dumpWake;
+    bool finished = false;
+    std::thread dumper;
+    if (timed && options.dumpTo && options.dumpEverySeconds > 0.0) {
+        dumper = std::thread([&]() {
+            auto interval = std::chrono::duration<double>(options.dumpEverySeconds);
+            std::unique_lock<std::mutex> lock(dumpMutex);
+            while (!dumpWake.wait_for(lock, interval, [&] { return finished; })) {
+                BatchLatencies snapshot;
+                for (const auto& w : workerLatencies) snapshot.merge(w);
+                snapshot.write(*options.dumpTo, engineName(options.engine));
+            }
+        });
+    }
+
+    if (threads == 1) {
+        traceThreadName("batch worker 0"); // the caller's thread, named like the pool's
+        worker(0);
+    } else {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; t++) {
+            pool.emplace_back([&worker, t]() {
+                traceThreadName("batch worker " + std::to_string(t));
+                worker(t);
+            });
+        }
+        for (auto& th : pool) th.join();
+    }
+
+    if (dumper.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(dumpMutex);
+            finished = true;
+        }
+        dumpWake.notify_one();
+        dumper.join();
+    }
+    for (const auto& w : workerLatencies) options.latencies->merge(w);
+    return results;
+}
+
+// Merges the per-query stats into one series per piece, labeled for writePrometheus.
+inline std::vector<LabeledStats> batchStatsByPiece(const std::vector<BatchQuery>& queries,
+                                                   const std::vector<BatchResult>& results,
+                                                   const std::string& engineName) {
+    std::vector<LabeledStats> series(PIECE_COUNT);
+    for (int p = 0; p < PIECE_COUNT; p++) {
+        series[p].labels = "engine=\"" + engineName + "\",piece=\"" + pieceName((PieceType)p) + "\"";
+    }
+    for (size_t i = 0; i < queries.size() && i < results.size(); i++) {
+        series[queries[i].piece].searches++;
+        series[queries[i].piece].stats.merge(results[i].stats);
+    }
+    series.erase(std::remove_if(series.begin(), series.end(),
+                                [](const LabeledStats& s) { return s.searches == 0; }),
+                 series.end());
+    return series;
+}
@@ -0,0 +1,180 @@
+// chess_moves.h
+// Board geometry and move generation, shared by the visualizer and the tools.
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+const int BOARD_SIZE = 8;
+
+// Point Helper
+struct Point {
+    int x, y;
+    bool operator<(const Point& other) const {
+        if (x != other.x) return x < other.x;
+        return y < other.y;
+    }
+    bool operator==(const Point& other) const {
+        return x == other.x && y == other.y;
+    }
+    bool operator!=(const Point& other) const {
+        return !(*this == other);
+    }
+};
+
+enum PieceType { KNIGHT_P, KING_P, ROOK_P, BISHOP_P, QUEEN_P };
+const int PIECE_COUNT = 5;
+
+inline const char* pieceName(PieceType p) {
+    switch (p) {
+        case KNIGHT_P: return "knight";
+        case KING_P:   return "king";
+        case ROOK_P:   return "rook";
+        case BISHOP_P: return "bishop";
+        case QUEEN_P:  return "queen";
+        default: return "?";
+    }
+}
+
+// Pre-declared movement function type
+using MoveFunc = std::function<std::vector<Point>(const Point&)>;
+
+// Knight Moves (unchanged)
+const std::vector<Point> KNIGHT_MOVES = {
+    {2, 1}, {2, -1}, {-2, 1}, {-2, -1},
+    {1, 2}, {1, -2}, {-1, 2}, {-1, -2}
+};
+
+// --- Movement functions for all pieces ---
+
+inline std::vector<Point> knightMoves(const Point& p) {
+    std::vector<Point> out;
+    for (const auto &m : KNIGHT_MOVES) {
+        Point n = {p.x + m.x, p.y + m.y};
+        if (n.x >= 0 && n.x < BOARD_SIZE && n.y >= 0 && n.y < BOARD_SIZE) out.push_back(n);
+    }
+    return out;
+}
+
+inline std::vector<Point> kingMoves(const Point& p) {
+    std::vector<Point> out;
+    for (int dx = -1; dx <= 1; dx++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            if (dx == 0 && dy == 0) continue;
+            Point n = {p.x + dx, p.y + dy};
+            if (n.x >= 0 && n.x < BOARD_SIZE && n.y >= 0 && n.y < BOARD_SIZE) out.push_back(n);
+        }
+    }
+    return out;
+}
+
+// sliding helper: iterate in direction until edge
+inline std::vector<Point> slidingMoves(const Point& p, const std::vector<std::pair<int,int>>& dirs) {
+    std::vector<Point> out;
+    for (auto d : dirs) {
+        int dx = d.first, dy = d.second;
+        int nx = p.x + dx, ny = p.y + dy;
+        while (nx >= 0 && nx < BOARD_SIZE && ny >= 0 && ny < BOARD_SIZE) {
+            out.push_back({nx, ny});
+            nx += dx; ny += dy;
+        }
+    }
+    return out;
+}
+
+const std::vector<std::pair<int,int>> ROOK_DIRS = {
+    {1,0},{-1,0},{0,1},{0,-1}
+};
+const std::vector<std::pair<int,int>> BISHOP_DIRS = {
+    {1,1},{1,-1},{-1,1},{-1,-1}
+};
+const std::vector<std::pair<int,int>> QUEEN_DIRS = {
+    {1,0},{-1,0},{0,1},{0,-1},
+    {1,1},{1,-1},{-1,1},{-1,-1}
+};
+
+inline std::vector<Point> rookMoves(const Point& p) {
+    return slidingMoves(p, ROOK_DIRS);
+}
+
+inline std::vector<Point> bishopMoves(const Point& p) {
+    return slidingMoves(p, BISHOP_DIRS);
+}
+
+inline std::vector<Point> queenMoves(const Point& p) {
+    return slidingMoves(p, QUEEN_DIRS);
+}
+
+inline MoveFunc moveFunctionFor(PieceType p) {
+    switch (p) {
+        case KNIGHT_P: return knightMoves;
+        case KING_P:   return kingMoves;
+        case ROOK_P:   return rookMoves;
+        case BISHOP_P: return bishopMoves;
+        case QUEEN_P:  return queenMoves;
+        default: return knightMoves;
+    }
+}
+
+// --- Boards of any size, with optional obstacles ---
+// The visualizer is fixed to an empty 8x8 board; the search engines and the
+// tools take a Board so they can run on bigger boards with blocked squares.
+// Sliding pieces stop in front of an obstacle, the knight jumps over them.
+
+// A number no other board has had; see Board::version
+inline uint64_t newBoardVersion() {
+    static std::atomic<uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+struct Board {
+    int size = BOARD_SIZE;
+    std::vector<unsigned char> blocked; // size*size, row major; empty = no obstacles
+    // Equal versions mean equal boards: every board starts with a new one and
+    // copies keep it, so whoever changes size or blocked on a board that may
+    // have been searched calls touch(). Engines key per-board caches on it.
+    uint64_t version = newBoardVersion();
+
+    void touch() { version = newBoardVersion(); }
+
+    int cells() const { return size * size; }
+    int index(const Point& p) const { return p.y * size + p.x; }
+    Point point(int idx) const { return {idx % size, idx / size}; }
+    bool inside(int x, int y) const { return x >= 0 && x < size && y >= 0 && y < size; }
+    bool isFree(int x, int y) const {
+        return inside(x, y) && (blocked.empty() || !blocked[y * size + x]);
+    }
+};
+
+// Appends the moves of `piece` from p to out (out is not cleared), so a
+// caller that keeps `out` around generates moves without allocating.
+inline void generateMoves(const Board& board, PieceType piece, const Point& p, std::vector<Point>& out) {
+    switch (piece) {
+        case KNIGHT_P:
+            for (const auto& m : KNIGHT_MOVES) {
+                if (board.isFree(p.x + m.x, p.y + m.y)) out.push_back({p.x + m.x, p.y + m.y});
+            }
+            break;
+        case KING_P:
+            for (int dx = -1; dx <= 1; dx++) {
+                for (int dy = -1; dy <= 1; dy++) {
+                    if (dx == 0 && dy == 0) continue;
+                    if (board.isFree(p.x + dx, p.y + dy)) out.push_back({p.x + dx, p.y + dy});
+                }
+            }
+            break;
+        default: {
+            const auto& dirs = piece == ROOK_P ? ROOK_DIRS : piece == BISHOP_P ? BISHOP_DIRS : QUEEN_DIRS;
+            for (auto d : dirs) {
+                int nx = p.x + d.first, ny = p.y + d.second;
+                while (board.isFree(nx, ny)) {
+                    out.push_back({nx, ny});
+                    nx += d.first; ny += d.second;
+                }
+            }
+            break;
+        }
+    }
+}
@@ -0,0 +1,465 @@
+// chess_search.h
+// Headless shortest-path search for one chess piece, without drawing or pacing.
+//
+// ReferenceEngine is the visualizer's stepBFS loop as it is (deque + set + map,
+// goal test when a square is popped). ArrayEngine runs the same BFS on flat
+// arrays indexed by square, stops as soon as the goal is discovered and keeps
+// its buffers between queries, so a warmed-up engine does not allocate.
+// TableEngine is ArrayEngine with moves read from the precomputed tables in
+// move_tables.h instead of generated with bounds checks. CsrEngine exports
+// the board to a CSR graph per piece (board_graph.h) and runs the generic
+// BFS of csr_bfs.h on it, the same BFS the tree tools use; "csr-hilbert"
+// numbers the squares along a Hilbert curve first (graph_reorder.h).
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "board_graph.h"
+#include "chess_moves.h"
+#include "csr_bfs.h"
+#include "move_tables.h"
+#include "perf_counters.h"
+#include "search_stats.h"
+
+struct SearchResult {
+    int distance = -1;        // moves from start to goal, -1 if unreachable
+    std::vector<Point> path;  // start .. goal, empty if unreachable
+    SearchStats stats;
+};
+
+class SearchEngine {
+public:
+    virtual ~SearchEngine() {}
+    virtual const char* name() const = 0;
+    virtual SearchResult search(const Board& board, PieceType piece, Point start, Point goal) = 0;
+    // Bytes of search state held at the peak of the last query
+    virtual size_t stateBytes() const = 0;
+
+    // Allocations a warmed-up engine may make per query; the benchmark fails
+    // when an engine goes over. Negative means no promise.
+    virtual double allocBudgetPerQuery() const { return -1.0; }
+
+    // Opt-in hardware counter profiling (perf_counters.h); nullptr turns it off
+    void setProfiler(PhaseProfiler* p) { profiler = p; }
+
+protected:
+    PhaseProfiler* profiler = nullptr;
+};
+
+// Rough size of one std::set / std::map node on 64-bit libstdc++ / libc++
+// (three pointers + color) in addition to the stored value.
+const size_t TREE_NODE_OVERHEAD = 32;
+
+// --- Reference engine: same data structures and order as stepBFS ---
+
+class ReferenceEngine : public SearchEngine {
+public:
+    const char* name() const override { return "reference"; }
+
+    SearchResult search(const Board& board, PieceType piece, Point start, Point goal) override {
+        SearchResult result;
+        SearchStats& stats = result.stats;
+        PhaseClock clock;
+        LevelCounter levels;
+        std::deque<Point> queue;
+        std::set<Point> visited;
+        std::map<Point, Point> parents;
+        size_t maxQueue = 1;
+        bool found = false;
+
+        queue.push_back(start);
+        visited.insert(start);
+        parents[start] = {-1, -1};
+        clock.lap(stats, PHASE_SETUP);
+        if (profiler) {
+            profiler->setPiece(piece);
+            profiler->begin(PERF_PHASE_EXPAND);
+        }
+
+        while (!queue.empty()) {
+            Point current = queue.front();
+            queue.pop_front();
+            stats.nodesPopped++;
+            levels.popped(stats);
+
+            if (current == goal) {
+                found = true;
+                break;
+            }
+
+            std::vector<Point> neighbors;
+            if (profiler) profiler->begin(PERF_PHASE_NEIGHBORS);
+            generateMoves(board, piece, current, neighbors);
+            if (profiler) profiler->end();
+            if (SEARCH_STATS) stats.neighborsGenerated += neighbors.size();
+            for (const auto& neighbor : neighbors) {
+                if (visited.find(neighbor) == visited.end()) {
+                    visited.insert(neighbor);
+                    parents[neighbor] = current;
+                    queue.push_back(neighbor);
+                    levels.pushed();
+                } else if (SEARCH_STATS) {
+                    stats.duplicatesRejected++;
+                }
+            }
+            if (queue.size() > maxQueue) maxQueue = queue.size();
+        }
+        clock.lap(stats, PHASE_EXPAND);
+        if (profiler) {
+            profiler->end();
+            profiler->begin(PERF_PHASE_RECONSTRUCT);
+        }
+
+        if (found) {
+            Point curr = goal;
+            while (curr.x != -1) {
+                result.path.push_back(curr);
+                if (curr == start) break;
+                curr = parents[curr];
+            }
+            result.path = std::vector<Point>(result.path.rbegin(), result.path.rend());
+            result.distance = (int)result.path.size() - 1;
+        }
+
+        lastStateBytes = visited.size() * (TREE_NODE_OVERHEAD + sizeof(Point))
+                       + parents.size() * (TREE_NODE_OVERHEAD + 2 * sizeof(Point))
+                       + maxQueue * sizeof(Point);
+        stats.maxFrontier = maxQueue;
+        stats.peakStateBytes = lastStateBytes;
+        clock.lap(stats, PHASE_RECONSTRUCT);
+        if (profiler) profiler->end();
+        return result;
+    }
+
+    size_t stateBytes() const override { return lastStateBytes; }
+
+private:
+    size_t lastStateBytes = 0;
+};
+
+// --- Array engine: flat per-square arrays reused across queries ---
+
+class ArrayEngine : public SearchEngine {
+public:
+    const char* name() const override { return "array"; }
+    double allocBudgetPerQuery() const override { return 1.0; } // the returned path
+
+    SearchResult search(const Board& board, PieceType piece, Point start, Point goal) override {
+        SearchResult result;
+        SearchStats& stats = result.stats;
+        PhaseClock clock;
+        LevelCounter levels;
+        int cells = board.cells();
+        if ((int)parent.size() < cells) {
+            parent.resize(cells);
+            seen.assign(cells, 0);
+            queue.resize(cells);
+            epoch = 0;
+        }
+        // Most moves any piece has on this board (queen in the center), so
+        // the neighbor buffer never grows in the middle of a search
+        size_t maxMoves = std::max<size_t>(8, 4 * (size_t)board.size);
+        if (neighbors.capacity() < maxMoves) neighbors.reserve(maxMoves);
+        // A new epoch marks every square unseen without clearing the array
+        if (++epoch == 0) {
+            std::fill(seen.begin(), seen.end(), 0);
+            epoch = 1;
+        }
+
+        int s = board.index(start), g = board.index(goal);
+        seen[s] = epoch;
+        parent[s] = -1;
+        size_t head = 0, tail = 0;
+        queue[tail++] = s;
+        bool found = s == g;
+        clock.lap(stats, PHASE_SETUP);
+        if (profiler) {
+            profiler->setPiece(piece);
+            profiler->begin(PERF_PHASE_EXPAND);
+        }
+
+        while (!found && head < tail) {
+            int current = queue[head++];
+            stats.nodesPopped++;
+            levels.popped(stats);
+            neighbors.clear();
+            if (profiler) profiler->begin(PERF_PHASE_NEIGHBORS);
+            generateMoves(board, piece, board.point(current), neighbors);
+            if (profiler) profiler->end();
+            if (SEARCH_STATS) stats.neighborsGenerated += neighbors.size();
+            for (const auto& n : neighbors) {
+                int idx = board.index(n);
+                if (seen[idx] == epoch) {
+                    if (SEARCH_STATS) stats.duplicatesRejected++;
+                    continue;
+                }
+                seen[idx] = epoch;
+                parent[idx] = current;
+                if (idx == g) { found = true; break; }
+                queue[tail++] = idx;
+                levels.pushed();
+            }
+            if (SEARCH_STATS && tail - head > stats.maxFrontier) stats.maxFrontier = tail - head;
+        }
+        clock.lap(stats, PHASE_EXPAND);
+        if (profiler) {
+            profiler->end();
+            profiler->begin(PERF_PHASE_RECONSTRUCT);
+        }
+
+        if (found) {
+            int length = 0;
+            for (int v = g; v != -1; v = parent[v]) length++;
+            result.path.resize(length);
+            for (int v = g; v != -1; v = parent[v]) result.path[--length] = board.point(v);
+            result.distance = (int)result.path.size() - 1;
+        }
+        lastStateBytes = parent.size() * sizeof(int32_t) + seen.size() * sizeof(uint32_t)
+                       + queue.size() * sizeof(int32_t) + neighbors.capacity() * sizeof(Point);
+        stats.peakStateBytes = lastStateBytes;
+        clock.lap(stats, PHASE_RECONSTRUCT);
+        if (profiler) profiler->end();
+        return result;
+    }
+
+    size_t stateBytes() const override { return lastStateBytes; }
+
+private:
+    std::vector<int32_t> parent;
+    std::vector<uint32_t> seen; // epoch in which the square was discovered
+    std::vector<int32_t> queue;
+    std::vector<Point> neighbors;
+    uint32_t epoch = 0;
+    size_t lastStateBytes = 0;
+};
+
+// --- Table engine: ArrayEngine on precomputed move tables ---
+
+class TableEngine : public SearchEngine {
+public:
+    const char* name() const override { return "table"; }
+    double allocBudgetPerQuery() const override { return 1.0; } // the returned path
+
+    SearchResult search(const Board& board, PieceType piece, Point start, Point goal) override {
+        SearchResult result;
+        SearchStats& stats = result.stats;
+        PhaseClock clock;
+        LevelCounter levels;
+        int cells = board.cells();
+        if ((int)parent.size() < cells) {
+            parent.resize(cells);
+            seen.assign(cells, 0);
+            queue.resize(cells);
+            epoch = 0;
+        }
+        size_t maxMoves = std::max<size_t>(8, 4 * (size_t)board.size);
+        if (neighbors.capacity() < maxMoves) neighbors.reserve(maxMoves);
+        if (++epoch == 0) {
+            std::fill(seen.begin(), seen.end(), 0);
+            epoch = 1;
+        }
+        bool stepper = piece == KNIGHT_P || piece == KING_P;
+        StepTableView steps = stepper ? stepTable(board.size, piece) : StepTableView();
+        RayTableView rays = stepper ? RayTableView() : rayTable(board.size);
+        const unsigned char* blocked = board.blocked.empty() ? nullptr : board.blocked.data();
+        int firstDir = piece == BISHOP_P ? 4 : 0;
+        int lastDir = piece == ROOK_P ? 4 : 8;
+
+        int s = board.index(start), g = board.index(goal);
+        seen[s] = epoch;
+        parent[s] = -1;
+        size_t head = 0, tail = 0;
+        queue[tail++] = s;
+        bool found = s == g;
+        clock.lap(stats, PHASE_SETUP);
+        if (profiler) {
+            profiler->setPiece(piece);
+            profiler->begin(PERF_PHASE_EXPAND);
+        }
+
+        while (!found && head < tail) {
+            int current = queue[head++];
+            stats.nodesPopped++;
+            levels.popped(stats);
+            neighbors.clear();
+            if (profiler) profiler->begin(PERF_PHASE_NEIGHBORS);
+            if (stepper) {
+                for (uint32_t i = steps.offsets[current]; i < steps.offsets[current + 1]; i++) {
+                    int32_t t = (int32_t)steps.targets[i];
+                    if (!blocked || !blocked[t]) neighbors.push_back(t);
+                }
+            } else {
+                for (int d = firstDir; d < lastDir; d++) {
+                    int32_t step = RAY_DIRS[d][1] * board.size + RAY_DIRS[d][0];
+                    int32_t t = current;
+                    for (uint32_t k = rays.length[current * 8 + d]; k > 0; k--) {
+                        t += step;
+                        if (blocked && blocked[t]) break;
+                        neighbors.push_back(t);
+                    }
+                }
+            }
+            if (profiler) profiler->end();
+            if (SEARCH_STATS) stats.neighborsGenerated += neighbors.size();
+            for (int32_t idx : neighbors) {
+                if (seen[idx] == epoch) {
+                    if (SEARCH_STATS) stats.duplicatesRejected++;
+                    continue;
+                }
+                seen[idx] = epoch;
+                parent[idx] = current;
+                if (idx == g) { found = true; break; }
+                queue[tail++] = idx;
+                levels.pushed();
+            }
+            if (SEARCH_STATS && tail - head > stats.maxFrontier) stats.maxFrontier = tail - head;
+        }
+        clock.lap(stats, PHASE_EXPAND);
+        if (profiler) {
+            profiler->end();
+            profiler->begin(PERF_PHASE_RECONSTRUCT);
+        }
+
+        if (found) {
+            int length = 0;
+            for (int v = g; v != -1; v = parent[v]) length++;
+            result.path.resize(length);
+            for (int v = g; v != -1; v = parent[v]) result.path[--length] = board.point(v);
+            result.distance = (int)result.path.size() - 1;
+        }
+        lastStateBytes = parent.size() * sizeof(int32_t) + seen.size() * sizeof(uint32_t)
+                       + queue.size() * sizeof(int32_t) + neighbors.capacity() * sizeof(int32_t);
+        stats.peakStateBytes = lastStateBytes;
+        clock.lap(stats, PHASE_RECONSTRUCT);
+        if (profiler) profiler->end();
+        return result;
+    }
+
+    size_t stateBytes() const override { return lastStateBytes; }
+
+private:
+    std::vector<int32_t> parent;
+    std::vector<uint32_t> seen;
+    std::vector<int32_t> queue;
+    std::vector<int32_t> neighbors;
+    uint32_t epoch = 0;
+    size_t lastStateBytes = 0;
+};
+
+// --- CSR engine: the generic CSR BFS on exported board graphs ---
+
+class CsrEngine : public SearchEngine {
+public:
+    explicit CsrEngine(SquareCurve curve = SQUARES_ROWS) : curve(curve) {}
+
+    const char* name() const override { return curve == SQUARES_HILBERT ? "csr-hilbert" : "csr"; }
+    double allocBudgetPerQuery() const override { return 1.0; } // the returned path
+
+    SearchResult search(const Board& board, PieceType piece, Point start, Point goal) override {
+        SearchResult result;
+        SearchStats& stats = result.stats;
+        PhaseClock clock;
+        // One exported graph per piece, rebuilt only when the board changes:
+        // a known version is a hit in O(1), a new one is compared once
+        Export& e = exports[piece];
+        if (e.valid && e.version != board.version && e.size == board.size && e.blocked == board.blocked) {
+            e.version = board.version;
+        }
+        if (!e.valid || e.version != board.version) {
+            e.ids = squareOrder(board, curve);
+            e.graph = boardGraph(board, piece);
+            if (curve != SQUARES_ROWS) e.graph = permuteCsr(e.graph, e.ids);
+            e.size = board.size;
+            e.blocked = board.blocked;
+            e.version = board.version;
+            e.valid = true;
+        }
+        bfs.reset(e.graph);
+        if (squares.capacity() < e.graph.n) squares.reserve(e.graph.n); // the longest possible path
+        uint32_t s = e.ids.rank[board.index(start)], g = e.ids.rank[board.index(goal)];
+        clock.lap(stats, PHASE_SETUP);
+        if (profiler) {
+            profiler->setPiece(piece);
+            profiler->begin(PERF_PHASE_EXPAND);
+        }
+
+        uint32_t levels;
+        bfs.run(s, levels, nullptr, g);
+        clock.lap(stats, PHASE_EXPAND);
+        if (profiler) {
+            profiler->end();
+            profiler->begin(PERF_PHASE_RECONSTRUCT);
+        }
+
+        if (bfs.foundGoal()) {
+            bfs.pathToLast(squares);
+            result.path.resize(squares.size());
+            for (size_t i = 0; i < squares.size(); i++) result.path[i] = board.point((int)e.ids.order[squares[i]]);
+            result.distance = (int)levels;
+        }
+        stats.nodesPopped = bfs.expandedCount();
+        if (SEARCH_STATS) {
+            stats.neighborsGenerated = bfs.scannedCount();
+            stats.duplicatesRejected = bfs.scannedCount() - std::min<uint64_t>(bfs.scannedCount(), bfs.reachedCount() - 1);
+            stats.levels = bfs.foundGoal() ? levels : levels + 1;
+            stats.maxFrontier = bfs.reachedCount() - bfs.expandedCount();
+        }
+        size_t graphBytes = 0;
+        for (const Export& x : exports) graphBytes += x.graph.bytes() + x.ids.bytes();
+        lastStateBytes = bfs.bytes() + squares.capacity() * sizeof(uint32_t) + graphBytes;
+        stats.peakStateBytes = lastStateBytes;
+        clock.lap(stats, PHASE_RECONSTRUCT);
+        if (profiler) profiler->end();
+        return result;
+    }
+
+    size_t stateBytes() const override { return lastStateBytes; }
+
+private:
+    struct Export {
+        bool valid = false;
+        uint64_t version = 0;
+        int size = 0;
+        std::vector<unsigned char> blocked;
+        VertexPermutation ids; // square index <-> vertex id
+        CompactCsrGraph graph;
+    };
+
+    SquareCurve curve;
+    Export exports[PIECE_COUNT];
+    CsrBfs<CompactCsrGraph> bfs;
+    std::vector<uint32_t> squares;
+    size_t lastStateBytes = 0;
+};
+
+// --- Engine registry ---
+
+enum EngineType { ENGINE_REFERENCE, ENGINE_ARRAY, ENGINE_TABLE, ENGINE_CSR, ENGINE_CSR_HILBERT };
+const int ENGINE_COUNT = 5;
+
+inline const char* engineName(EngineType type) {
+    switch (type) {
+        case ENGINE_REFERENCE: return "reference";
+        case ENGINE_ARRAY:     return "array";
+        case ENGINE_TABLE:     return "table";
+        case ENGINE_CSR:       return "csr";
+        case ENGINE_CSR_HILBERT: return "csr-hilbert";
+        default: return "?";
+    }
+}
+
+inline std::unique_ptr<SearchEngine> makeEngine(EngineType type) {
+    switch (type) {
+        case ENGINE_REFERENCE: return std::unique_ptr<SearchEngine>(new ReferenceEngine());
+        case ENGINE_ARRAY:     return std::unique_ptr<SearchEngine>(new ArrayEngine());
+        case ENGINE_TABLE:     return std::unique_ptr<SearchEngine>(new TableEngine());
+        case ENGINE_CSR:       return std::unique_ptr<SearchEngine>(new CsrEngine());
+        case ENGINE_CSR_HILBERT: return std::unique_ptr<SearchEngine>(new CsrEngine(SQUARES_HILBERT));
+        default: return nullptr;
+    }
+}
@@ -0,0 +1,294 @@
+// compressed_csr.h
+// CSR graph with delta-encoded, group-varint adjacency lists, for graphs
+// whose plain uint32 targets do not fit in memory. CsrBfs (csr_bfs.h) runs
+// on it directly, decoding each list as it is expanded.
+//
+// Each vertex's bytes, at data[offsets[v]]: its degree as a varint, then
+// one value per target in groups of four: the first target as the zigzag
+// of target - v, then the gaps between consecutive sorted targets. Each
+// group has a control byte with a 2-bit length (1 .. 4 bytes) per value;
+// all the control bytes come first and then the values' little-endian
+// bytes (the Stream VByte layout: the next group's control byte never waits
+// on this group's length). A short last group leaves unused control bits 0.
+// Neighbors with nearby ids (graph_reorder.h) make small gaps, so reordering
+// first shrinks the lists further.
+//
+// Lists of SIMD_MIN_DEGREE or more are decoded with SSSE3 when the CPU has
+// it (chosen at run time, so the plain -O2 build uses it too): one pshufb
+// spreads a group's bytes into four 32-bit lanes through a table indexed by
+// the control byte, and two shifted adds turn the gaps into targets.
+// Shorter lists, the bulk of road-like graphs, and CPUs without SSSE3 use a
+// scalar loop that reads each value with one 4-byte load and a mask. Both may read up to
+// DECODE_PADDING bytes past a list, which the data array is padded for, and
+// the SSSE3 path writes up to three values past the end of the list, which
+// the decode buffer is sized for.
+//
+// Weights are not kept: the compressed graph is for traversal.
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COMPRESSED_CSR_SSSE3 1
+#else
+#define COMPRESSED_CSR_SSSE3 0
+#endif
+
+#include "csr_bfs.h"
+#include "csr_graph.h"
+#include "thread_pool.h"
+
+const size_t DECODE_PADDING = 16;
+const size_t DECODE_SLACK = 3;       // extra values a group decode may write
+const uint32_t SIMD_MIN_DEGREE = 8; // shorter lists decode faster one value at a time
+
+namespace compressed_detail {
+
+inline uint8_t* putVarint(uint8_t* p, uint32_t x) {
+    while (x >= 0x80) {
+        *p++ = (uint8_t)(x | 0x80);
+        x >>= 7;
+    }
+    *p++ = (uint8_t)x;
+    return p;
+}
+
+inline const uint8_t* getVarint(const uint8_t* p, uint32_t& x) {
+    if (*p < 0x80) { // the common one-byte case
+        x = *p;
+        return p + 1;
+    }
+    x = *p & 0x7F;
+    for (int shift = 7; *p++ & 0x80; shift += 7) x |= (uint32_t)(*p & 0x7F) << shift;
+    return p;
+}
+
+inline size_t varintBytes(uint32_t x) {
+    size_t bytes = 1;
+    while (x >= 0x80) {
+        x >>= 7;
+        bytes++;
+    }
+    return bytes;
+}
+
+// first - v as a wrapped 32-bit difference, small when first is near v on
+// either side
+inline uint32_t zigzag(uint32_t d) { return d << 1 ^ (uint32_t)((int32_t)d >> 31); }
+inline uint32_t unzigzag(uint32_t z) { return z >> 1 ^ (0u - (z & 1)); }
+
+inline uint32_t byteLength(uint32_t x) { return x < (1u << 8) ? 1 : x < (1u << 16) ? 2 : x < (1u << 24) ? 3 : 4; }
+
+// Shuffle masks and byte counts of the 256 control bytes
+struct GroupTables {
+    alignas(16) uint8_t shuffle[256][16];
+    uint8_t length[256]; // data bytes of all four lanes
+
+    GroupTables() {
+        for (int c = 0; c < 256; c++) {
+            uint8_t at = 0;
+            for (int lane = 0; lane < 4; lane++) {
+                int len = (c >> (2 * lane) & 3) + 1;
+                for (int b = 0; b < 4; b++) shuffle[c][4 * lane + b] = b < len ? at + b : 0x80;
+                at += len;
+            }
+            length[c] = at;
+        }
+    }
+};
+
+inline const GroupTables GROUP_TABLES;
+
+// The i-th value stored for a list: the first target relative to v, then gaps
+inline uint32_t listValue(uint32_t v, const uint32_t* targets, size_t i) {
+    return i == 0 ? zigzag(targets[0] - v) : targets[i] - targets[i - 1];
+}
+
+// Bytes of the encoded list of targets[0 .. count) of vertex v
+inline size_t encodedBytes(uint32_t v, const uint32_t* targets, size_t count) {
+    size_t bytes = varintBytes((uint32_t)count) + (count + 3) / 4;
+    for (size_t i = 0; i < count; i++) bytes += byteLength(listValue(v, targets, i));
+    return bytes;
+}
+
+inline uint8_t* encodeList(uint8_t* p, uint32_t v, const uint32_t* targets, size_t count) {
+    p = putVarint(p, (uint32_t)count);
+    uint8_t* control = p;
+    p += (count + 3) / 4;
+    std::fill(control, p, 0);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = listValue(v, targets, i);
+        uint32_t len = byteLength(value);
+        control[i / 4] |= (uint8_t)((len - 1) << (2 * (i % 4)));
+        for (uint32_t b = 0; b < len; b++) *p++ = (uint8_t)(value >> (8 * b));
+    }
+    return p;
+}
+
+// The count targets of v from the control bytes at control and the value
+// bytes that follow them
+inline void decodeGroupsScalar(const uint8_t* control, size_t count, uint32_t v, uint32_t* out) {
+    static const uint32_t MASKS[5] = {0, 0xFF, 0xFFFF, 0xFFFFFF, 0xFFFFFFFF};
+    const uint8_t* p = control + (count + 3) / 4;
+    uint32_t prev = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t len = (control[i / 4] >> (2 * (i % 4)) & 3) + 1;
+        uint32_t value;
+        std::memcpy(&value, p, 4);
+        value &= MASKS[len];
+        p += len;
+        prev = i == 0 ? v + unzigzag(value) : prev + value;
+        out[i] = prev;
+    }
+}
+
+#if COMPRESSED_CSR_SSSE3
+// The same, four at a time; writes whole groups, so up to DECODE_SLACK values past count
+__attribute__((target("ssse3")))
+inline void decodeGroupsSsse3(const uint8_t* control, size_t count, uint32_t v, uint32_t* out) {
+    const GroupTables& t = GROUP_TABLES;
+    const uint8_t* p = control + (count + 3) / 4;
+    __m128i last = _mm_setzero_si128();
+    for (size_t i = 0; i < count; i += 4, control++) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)p);
+        __m128i values = _mm_shuffle_epi8(bytes, _mm_load_si128((const __m128i*)t.shuffle[*control]));
+        if (i == 0) {
+            // Lane 0 of the first group becomes the first target
+            uint32_t z = (uint32_t)_mm_cvtsi128_si32(values);
+            values = _mm_add_epi32(values, _mm_cvtsi32_si128((int)(v + unzigzag(z) - z)));
+        }
+        // Prefix sums of the four values, on top of the previous group's last target
+        values = _mm_add_epi32(values, _mm_slli_si128(values, 4));
+        values = _mm_add_epi32(values, _mm_slli_si128(values, 8));
+        last = _mm_add_epi32(values, _mm_shuffle_epi32(last, 0xFF));
+        _mm_storeu_si128((__m128i*)(out + i), last);
+        p += t.length[*control];
+    }
+}
+#endif
+
+inline bool haveSsse3() {
+#if COMPRESSED_CSR_SSSE3
+    static const bool yes = __builtin_cpu_supports("ssse3");
+    return yes;
+#else
+    return false;
+#endif
+}
+
+// Decodes the list at p of vertex v into out (see BasicCompressedCsrGraph::decode)
+inline size_t decodeList(const uint8_t* p, uint32_t v, uint32_t* out, bool simd) {
+    uint32_t count;
+    p = getVarint(p, count);
+#if COMPRESSED_CSR_SSSE3
+    if (simd && count >= SIMD_MIN_DEGREE) {
+        decodeGroupsSsse3(p, count, v, out);
+        return count;
+    }
+#endif
+    decodeGroupsScalar(p, count, v, out);
+    return count;
+}
+
+} // namespace compressed_detail
+
+template <typename Offset>
+struct BasicCompressedCsrGraph {
+    using OffsetType = Offset;
+
+    uint32_t n = 0;
+    uint64_t arcCount = 0;
+    uint32_t maxDegree = 0;
+    std::vector<Offset> offsets; // n + 1 byte positions in data
+    std::vector<uint8_t> data;   // the lists, then DECODE_PADDING zero bytes
+
+    uint64_t arcs() const { return arcCount; }
+
+    uint64_t degree(uint32_t v) const {
+        uint32_t d;
+        compressed_detail::getVarint(data.data() + offsets[v], d);
+        return d;
+    }
+
+    // Writes v's targets, ascending, to out, which must have room for
+    // degree(v) + DECODE_SLACK values; returns the degree
+    size_t decode(uint32_t v, uint32_t* out) const {
+        return compressed_detail::decodeList(data.data() + offsets[v], v, out, compressed_detail::haveSsse3());
+    }
+
+    size_t bytes() const { return offsets.size() * sizeof(Offset) + data.size(); }
+};
+
+using CompressedCsrGraph = BasicCompressedCsrGraph<uint64_t>;
+using CompactCompressedCsrGraph = BasicCompressedCsrGraph<uint32_t>;
+
+// Encodes any CSR graph or view (lists are sorted on the way if they are
+// not); false when the data does not fit Offset. Lists are sized, then
+// encoded into place, in parallel.
+template <typename Offset, typename Graph>
+bool compressCsr(const Graph& g, BasicCompressedCsrGraph<Offset>& out, ThreadPool& pool) {
+    using namespace compressed_detail;
+    const size_t GRAIN = 1024;
+    std::vector<uint64_t> at(g.n + 1, 0);
+    std::vector<uint32_t> maxDegree(pool.size(), 0);
+    // Sorted copy of u's list in scratch, or the list itself when already sorted
+    auto sortedList = [&](uint32_t u, std::vector<uint32_t>& scratch) {
+        const uint32_t* first = g.begin(u);
+        const uint32_t* last = g.end(u);
+        if (std::is_sorted(first, last)) return first;
+        scratch.assign(first, last);
+        std::sort(scratch.begin(), scratch.end());
+        return (const uint32_t*)scratch.data();
+    };
+    pool.parallelFor(g.n, GRAIN, [&](size_t b, size_t e, int tid) {
+        std::vector<uint32_t> scratch;
+        for (size_t u = b; u < e; u++) {
+            size_t count = g.degree((uint32_t)u);
+            at[u + 1] = encodedBytes((uint32_t)u, sortedList((uint32_t)u, scratch), count);
+            maxDegree[tid] = std::max(maxDegree[tid], (uint32_t)count);
+        }
+    });
+    for (uint32_t u = 0; u < g.n; u++) at[u + 1] += at[u];
+    if (at[g.n] + DECODE_PADDING > (uint64_t)(Offset)~Offset(0)) {
+        std::cerr << at[g.n] << " bytes of lists do not fit " << 8 * sizeof(Offset) << "-bit offsets" << std::endl;
+        return false;
+    }
+
+    out.n = g.n;
+    out.arcCount = g.arcs();
+    out.maxDegree = *std::max_element(maxDegree.begin(), maxDegree.end());
+    out.offsets.assign(at.begin(), at.end());
+    out.data.assign(at[g.n] + DECODE_PADDING, 0);
+    pool.parallelFor(g.n, GRAIN, [&](size_t b, size_t e, int) {
+        std::vector<uint32_t> scratch;
+        for (size_t u = b; u < e; u++) {
+            encodeList(out.data.data() + at[u], (uint32_t)u, sortedList((uint32_t)u, scratch), g.degree((uint32_t)u));
+        }
+    });
+    return true;
+}
+
+// CsrBfs on a compressed graph: each list is decoded into a buffer as its
+// vertex is expanded
+template <typename Offset>
+struct NeighborReader<BasicCompressedCsrGraph<Offset>> {
+    using Graph = BasicCompressedCsrGraph<Offset>;
+
+    void reset(const Graph& g) {
+        if (buffer.size() < g.maxDegree + DECODE_SLACK) buffer.resize(g.maxDegree + DECODE_SLACK);
+        simd = compressed_detail::haveSsse3();
+    }
+    const uint32_t* read(const Graph& g, uint32_t u, size_t& count) {
+        count = compressed_detail::decodeList(g.data.data() + g.offsets[u], u, buffer.data(), simd);
+        return buffer.data();
+    }
+    void prefetch(const Graph& g, uint32_t u) const { __builtin_prefetch(g.data.data() + g.offsets[u]); }
+    size_t bytes() const { return buffer.size() * sizeof(uint32_t); }
+
+    std::vector<uint32_t> buffer;
+    bool simd = false;
+};
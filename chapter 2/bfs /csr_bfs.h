@@ -0,0 +1,146 @@
+// csr_bfs.h
+// The visualizer's stepBFS loop on any BasicCsrGraph: one BFS for the tree
+// tools (CsrGraph) and the exported board graphs (CompactCsrGraph, see
+// board_graph.h).
+//
+// The queue is a flat array, visited is a bitmap and every queue entry
+// records the queue position of its parent instead of a per-vertex parent
+// map, so the BFS tree is written sequentially and a path is read back from
+// the last entry. Buffers are kept between runs (the bitmap is cleared per
+// run, n / 64 words).
+//
+// run() either stops as soon as a goal vertex is discovered, which is then
+// the last entry, or runs to the end, when the last entry is a farthest
+// vertex from the source (what double sweeps need). Each vertex is queued
+// once, and the adjacency of vertices coming up in the queue is prefetched.
+//
+// Lists are read through NeighborReader<Graph>: plain CSR graphs and views
+// hand out their target arrays in place, and other layouts specialize it
+// (compressed_csr.h decodes each list into a buffer).
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "csr_graph.h"
+
+template <typename Graph>
+struct NeighborReader {
+    void reset(const Graph&) {}
+    // The count targets of u
+    const uint32_t* read(const Graph& g, uint32_t u, size_t& count) {
+        count = g.degree(u);
+        return g.begin(u);
+    }
+    void prefetch(const Graph& g, uint32_t u) const { __builtin_prefetch(g.begin(u)); }
+    size_t bytes() const { return 0; }
+};
+
+template <typename Graph>
+class CsrBfs {
+public:
+    CsrBfs() {}
+    explicit CsrBfs(const Graph& graph) { reset(graph); }
+
+    // Runs on graph from now on; buffers only grow
+    void reset(const Graph& graph) {
+        g = &graph;
+        if (queue.size() < graph.n) {
+            queue.resize(graph.n);
+            from.resize(graph.n);
+        }
+        visitedWords = (graph.n + 63) / 64;
+        if (visited.size() < visitedWords) visited.resize(visitedWords);
+        reader.reset(graph);
+    }
+
+    // Returns the last vertex reached and sets levels to its distance from
+    // src: the goal if it was found (see foundGoal()), else a farthest vertex.
+    // dist, if given, gets the distance of every expanded vertex (all reached
+    // ones unless the run stopped at the goal); others are left alone.
+    uint32_t run(uint32_t src, uint32_t& levels, std::vector<uint32_t>* dist = nullptr, uint32_t goal = NO_VERTEX) {
+        std::fill(visited.begin(), visited.begin() + visitedWords, 0);
+        size_t head = 0, tail = 0;
+        queue[tail] = src;
+        from[tail++] = NO_VERTEX;
+        mark(src);
+        uint32_t depth = 0;
+        size_t levelEnd = 1;
+        scanned = 0;
+        found = src == goal;
+        while (head < tail && !found) {
+            // The queue is known ahead of time: start the cache misses for
+            // upcoming vertices' offsets and adjacency while this one runs
+            if (head + PREFETCH_OFFSETS < tail) __builtin_prefetch(&g->offsets[queue[head + PREFETCH_OFFSETS]]);
+            if (head + PREFETCH_TARGETS < tail) reader.prefetch(*g, queue[head + PREFETCH_TARGETS]);
+            uint32_t u = queue[head];
+            if (dist) (*dist)[u] = depth;
+            size_t count;
+            const uint32_t* targets = reader.read(*g, u, count);
+            scanned += count;
+            for (size_t i = 0; i < count; i++) {
+                uint32_t v = targets[i];
+                if (isMarked(v)) continue;
+                mark(v);
+                queue[tail] = v;
+                from[tail++] = (uint32_t)head;
+                if (v == goal) {
+                    found = true;
+                    if (dist) (*dist)[v] = depth + 1;
+                    break;
+                }
+            }
+            head++;
+            if (found) {
+                depth++;
+            } else if (head == levelEnd && head < tail) {
+                depth++;
+                levelEnd = tail;
+            }
+        }
+        levels = depth;
+        expanded = head;
+        reached = tail;
+        return queue[tail - 1];
+    }
+
+    bool foundGoal() const { return found; }
+    // Vertices reached (queued) and expanded by the last run, and the arcs scanned
+    size_t reachedCount() const { return reached; }
+    size_t expandedCount() const { return expanded; }
+    uint64_t scannedCount() const { return scanned; }
+
+    // The last run's BFS tree by queue position: entry i (0 .. reachedCount())
+    // holds vertex queued(i), whose parent is entry parentEntry(i) < i
+    // (NO_VERTEX for the source)
+    uint32_t queued(size_t i) const { return queue[i]; }
+    uint32_t parentEntry(size_t i) const { return from[i]; }
+
+    // Path from the last run's source to the last vertex it reached
+    void pathToLast(std::vector<uint32_t>& path) const {
+        path.clear();
+        for (uint32_t at = (uint32_t)reached - 1; at != NO_VERTEX; at = from[at]) path.push_back(queue[at]);
+        std::reverse(path.begin(), path.end());
+    }
+
+    size_t bytes() const {
+        return (queue.size() + from.size()) * sizeof(uint32_t) + visited.size() * sizeof(uint64_t) + reader.bytes();
+    }
+
+private:
+    static const size_t PREFETCH_OFFSETS = 16;
+    static const size_t PREFETCH_TARGETS = 8;
+
+    void mark(uint32_t v) { visited[v >> 6] |= uint64_t(1) << (v & 63); }
+    bool isMarked(uint32_t v) const { return visited[v >> 6] >> (v & 63) & 1; }
+
+    const Graph* g = nullptr;
+    NeighborReader<Graph> reader;
+    std::vector<uint32_t> queue;
+    std::vector<uint32_t> from;     // queue position of each entry's parent
+    std::vector<uint64_t> visited;
+    size_t visitedWords = 0;
+    size_t reached = 0, expanded = 0;
+    uint64_t scanned = 0;
+    bool found = false;
+};
@@ -0,0 +1,185 @@
+// csr_graph.h
+// Compressed sparse row graphs for the large-graph benchmarks and the
+// exported board graphs.
+// Vertex v's neighbors are targets[offsets[v] .. offsets[v+1]). Undirected
+// graphs store every edge in both directions.
+//
+// The offset type is a parameter: CsrGraph (64-bit offsets) holds any number
+// of arcs, CompactCsrGraph (32-bit) halves the offset array for graphs with
+// fewer than 2^32 arcs, which is every board graph. Targets are always 32
+// bits. weights is either empty or holds one weight per arc, parallel to
+// targets; the BFS in csr_bfs.h ignores it.
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "thread_pool.h"
+
+const uint32_t NO_VERTEX = UINT32_MAX;
+
+struct Edge {
+    uint32_t u, v;
+};
+
+template <typename Offset>
+struct BasicCsrGraph {
+    using OffsetType = Offset;
+
+    uint32_t n = 0;
+    std::vector<Offset> offsets;   // n + 1 entries
+    std::vector<uint32_t> targets;
+    std::vector<uint32_t> weights; // empty, or one per arc
+
+    uint64_t arcs() const { return targets.size(); }
+    uint64_t degree(uint32_t v) const { return offsets[v + 1] - offsets[v]; }
+    const uint32_t* begin(uint32_t v) const { return targets.data() + offsets[v]; }
+    const uint32_t* end(uint32_t v) const { return targets.data() + offsets[v + 1]; }
+    bool weighted() const { return !weights.empty(); }
+    // Weight of the arc at targets[i]; 1 on unweighted graphs
+    uint32_t weight(uint64_t i) const { return weights.empty() ? 1 : weights[i]; }
+    size_t bytes() const {
+        return offsets.size() * sizeof(Offset) + (targets.size() + weights.size()) * sizeof(uint32_t);
+    }
+};
+
+using CsrGraph = BasicCsrGraph<uint64_t>;
+using CompactCsrGraph = BasicCsrGraph<uint32_t>;
+
+// Copies g with 32-bit offsets; false when it has 2^32 arcs or more
+inline bool compactCsr(const CsrGraph& g, CompactCsrGraph& out) {
+    if (g.arcs() > UINT32_MAX) {
+        std::cerr << g.arcs() << " arcs do not fit 32-bit offsets" << std::endl;
+        return false;
+    }
+    out.n = g.n;
+    out.offsets.assign(g.offsets.begin(), g.offsets.end());
+    out.targets = g.targets;
+    out.weights = g.weights;
+    return true;
+}
+
+// Builds an undirected CSR graph from edges handed out in chunks:
+// visit(chunk, tid, fn) calls fn(Edge) for every edge of that chunk, and
+// must give the same edges when called twice (it is, once to count degrees
+// and once to place the edges), so a generator can recompute its edges
+// instead of keeping them. Self-loops and duplicate edges are dropped.
+// Degrees are counted with atomic increments and edges are scattered into
+// place through per-vertex atomic cursors, then each adjacency list is
+// sorted and deduplicated in parallel.
+template <typename VisitChunk>
+CsrGraph buildCsrChunks(uint32_t n, size_t chunks, VisitChunk visit, ThreadPool& pool) {
+    CsrGraph g;
+    g.n = n;
+
+    std::vector<uint64_t> counts(n + 1, 0);
+    pool.parallelFor(chunks, 1, [&](size_t b, size_t e, int tid) {
+        for (size_t chunk = b; chunk < e; chunk++) {
+            visit(chunk, tid, [&](Edge edge) {
+                if (edge.u == edge.v) return;
+                __atomic_fetch_add(&counts[edge.u], 1, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&counts[edge.v], 1, __ATOMIC_RELAXED);
+            });
+        }
+    });
+
+    std::vector<uint64_t> cursor(n + 1, 0);
+    for (uint32_t v = 0; v < n; v++) cursor[v + 1] = cursor[v] + counts[v];
+    std::vector<uint32_t> scattered(cursor[n]);
+    std::vector<uint64_t> start = cursor;
+    pool.parallelFor(chunks, 1, [&](size_t b, size_t e, int tid) {
+        for (size_t chunk = b; chunk < e; chunk++) {
+            visit(chunk, tid, [&](Edge edge) {
+                if (edge.u == edge.v) return;
+                scattered[__atomic_fetch_add(&cursor[edge.u], 1, __ATOMIC_RELAXED)] = edge.v;
+                scattered[__atomic_fetch_add(&cursor[edge.v], 1, __ATOMIC_RELAXED)] = edge.u;
+            });
+        }
+    });
+
+    // Sort and dedupe each list in place; counts[v] becomes the kept length
+    pool.parallelFor(n, 1024, [&](size_t b, size_t e, int) {
+        for (size_t v = b; v < e; v++) {
+            uint32_t* first = scattered.data() + start[v];
+            uint32_t* last = scattered.data() + start[v + 1];
+            std::sort(first, last);
+            counts[v] = std::unique(first, last) - first;
+        }
+    });
+
+    g.offsets.assign(n + 1, 0);
+    for (uint32_t v = 0; v < n; v++) g.offsets[v + 1] = g.offsets[v] + counts[v];
+    g.targets.resize(g.offsets[n]);
+    pool.parallelFor(n, 1024, [&](size_t b, size_t e, int) {
+        for (size_t v = b; v < e; v++) {
+            std::copy(scattered.begin() + start[v], scattered.begin() + start[v] + counts[v],
+                      g.targets.begin() + g.offsets[v]);
+        }
+    });
+    return g;
+}
+
+// Builds an undirected CSR graph from an edge list (see buildCsrChunks)
+inline CsrGraph buildCsr(uint32_t n, const std::vector<Edge>& edges, ThreadPool& pool) {
+    const size_t GRAIN = 1 << 16;
+    size_t chunks = (edges.size() + GRAIN - 1) / GRAIN;
+    return buildCsrChunks(n, chunks, [&](size_t chunk, int, auto&& fn) {
+        size_t end = std::min(edges.size(), (chunk + 1) * GRAIN);
+        for (size_t i = chunk * GRAIN; i < end; i++) fn(edges[i]);
+    }, pool);
+}
+
+// Like buildCsr() with one weight per edge (weights[i] belongs to edges[i]);
+// of duplicate edges the lightest is kept. Each arc is scattered as
+// target << 32 | weight, so sorting a list orders it by target, then weight.
+inline CsrGraph buildWeightedCsr(uint32_t n, const std::vector<Edge>& edges, const std::vector<uint32_t>& weights,
+                                 ThreadPool& pool) {
+    const size_t GRAIN = 1 << 16;
+    std::vector<uint64_t> cursor(n + 1, 0);
+    pool.parallelFor(edges.size(), GRAIN, [&](size_t b, size_t e, int) {
+        for (size_t i = b; i < e; i++) {
+            if (edges[i].u == edges[i].v) continue;
+            __atomic_fetch_add(&cursor[edges[i].u + 1], 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&cursor[edges[i].v + 1], 1, __ATOMIC_RELAXED);
+        }
+    });
+    for (uint32_t v = 0; v < n; v++) cursor[v + 1] += cursor[v];
+    std::vector<uint64_t> start = cursor;
+    std::vector<uint64_t> packed(cursor[n]);
+    pool.parallelFor(edges.size(), GRAIN, [&](size_t b, size_t e, int) {
+        for (size_t i = b; i < e; i++) {
+            const Edge& edge = edges[i];
+            if (edge.u == edge.v) continue;
+            packed[__atomic_fetch_add(&cursor[edge.u], 1, __ATOMIC_RELAXED)] = (uint64_t)edge.v << 32 | weights[i];
+            packed[__atomic_fetch_add(&cursor[edge.v], 1, __ATOMIC_RELAXED)] = (uint64_t)edge.u << 32 | weights[i];
+        }
+    });
+
+    // Sort each list and keep the first arc per target; cursor[v] becomes the kept length
+    pool.parallelFor(n, 1024, [&](size_t b, size_t e, int) {
+        for (size_t v = b; v < e; v++) {
+            uint64_t* first = packed.data() + start[v];
+            uint64_t* last = packed.data() + start[v + 1];
+            std::sort(first, last);
+            cursor[v] = std::unique(first, last, [](uint64_t x, uint64_t y) { return x >> 32 == y >> 32; }) - first;
+        }
+    });
+
+    CsrGraph g;
+    g.n = n;
+    g.offsets.assign(n + 1, 0);
+    for (uint32_t v = 0; v < n; v++) g.offsets[v + 1] = g.offsets[v] + cursor[v];
+    g.targets.resize(g.offsets[n]);
+    g.weights.resize(g.offsets[n]);
+    pool.parallelFor(n, 1024, [&](size_t b, size_t e, int) {
+        for (size_t v = b; v < e; v++) {
+            for (uint64_t i = 0; i < g.degree((uint32_t)v); i++) {
+                uint64_t arc = packed[start[v] + i];
+                g.targets[g.offsets[v] + i] = (uint32_t)(arc >> 32);
+                g.weights[g.offsets[v] + i] = (uint32_t)arc;
+            }
+        }
+    });
+    return g;
+}
@@ -0,0 +1,283 @@
+// dynamic_tree_diameter.h
+// Diameter of every tree in a forest under edge insertions and deletions,
+// in O(log^2 n) amortized per operation, with a link-cut tree.
+//
+// Each splay tree holds one preferred path, ordered from top to bottom. A
+// splay subtree stands for a segment of that path plus everything hanging
+// off the segment's vertices through non-preferred ("virtual") children, and
+// keeps for that cluster:
+//   lmax  farthest vertex from the top of the segment, and its distance
+//   rmax  the same from the bottom (swapped when a path is reversed)
+//   diam  the longest path inside the cluster, with both endpoints
+// Every vertex also keeps its virtual children in two multisets: their
+// 1 + lmax (how far down each child reaches) and their diam. Since a tree's
+// root path carries the whole tree as its cluster, the diameter of a tree is
+// the diam of its root after access().
+//
+// A virtual child is removed by the multiset iterators saved when it was
+// added. Those live on the root of the child's splay tree and move to the
+// new root whenever that tree is splayed.
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "csr_graph.h"
+
+struct DynamicDiameter {
+    uint32_t length = 0;
+    uint32_t a = NO_VERTEX, b = NO_VERTEX;
+};
+
+class DynamicTreeDiameter {
+public:
+    explicit DynamicTreeDiameter(uint32_t n) : nodes(n), adjacency(n) {
+        for (uint32_t v = 0; v < n; v++) pull(v);
+    }
+
+    uint32_t size() const { return (uint32_t)nodes.size(); }
+
+    bool connected(uint32_t u, uint32_t v) { return u == v || findRoot(u) == findRoot(v); }
+
+    // Adds edge u-v; false (and no change) when it would close a cycle
+    bool link(uint32_t u, uint32_t v) {
+        if (connected(u, v)) return false;
+        makeRoot(u);
+        access(v);
+        nodes[u].parent = v;
+        addVirtual(v, u);
+        pull(v);
+        adjacency[u].push_back(v);
+        adjacency[v].push_back(u);
+        return true;
+    }
+
+    // Removes edge u-v; false when there is no such edge
+    bool cut(uint32_t u, uint32_t v) {
+        if (u == v) return false;
+        makeRoot(u);
+        access(v);
+        Node& nv = nodes[v];
+        if (nv.child[0] != u) return false;
+        pushDown(u);
+        if (nodes[u].child[1] != NIL) return false;
+        nv.child[0] = NIL;
+        nodes[u].parent = NIL;
+        pull(v);
+        pull(u);
+        eraseNeighbor(u, v);
+        eraseNeighbor(v, u);
+        return true;
+    }
+
+    // Cuts every edge of v (deleting a vertex in the editor)
+    void isolate(uint32_t v) {
+        while (!adjacency[v].empty()) cut(v, adjacency[v].back());
+    }
+
+    // Edges between u and v, NO_VERTEX if they are not connected
+    uint32_t distance(uint32_t u, uint32_t v) {
+        if (!connected(u, v)) return NO_VERTEX;
+        makeRoot(u);
+        access(v);
+        return nodes[v].size - 1;
+    }
+
+    // Diameter of the tree containing v
+    DynamicDiameter diameter(uint32_t v) {
+        access(v);
+        const Span& d = nodes[v].diam;
+        return {(uint32_t)d.length, d.a, d.b};
+    }
+
+    const std::vector<uint32_t>& neighbors(uint32_t v) const { return adjacency[v]; }
+
+private:
+    static const uint32_t NIL = NO_VERTEX;
+
+    struct Far {
+        int dist;
+        uint32_t v;
+        bool operator<(const Far& o) const { return dist != o.dist ? dist < o.dist : v < o.v; }
+        bool operator>(const Far& o) const { return o < *this; }
+    };
+    struct Span {
+        int length;
+        uint32_t a, b;
+        bool operator<(const Span& o) const {
+            if (length != o.length) return length < o.length;
+            return a != o.a ? a < o.a : b < o.b;
+        }
+        bool operator>(const Span& o) const { return o < *this; }
+    };
+    using Arms = std::multiset<Far, std::greater<Far>>;
+    using Spans = std::multiset<Span, std::greater<Span>>;
+
+    struct Node {
+        uint32_t child[2] = {NIL, NIL};
+        uint32_t parent = NIL; // splay parent, or path-parent at a splay root
+        bool flip = false;     // children still to be reversed
+        uint32_t size = 1;     // vertices on the path segment
+        Far lmax{0, 0}, rmax{0, 0};
+        Span diam{0, 0, 0};
+        Arms arms;             // virtual children: 1 + their lmax
+        Spans spans;           // virtual children: their diam
+        bool isVirtual = false;
+        Arms::iterator armIt;  // entries in the path-parent's sets
+        Spans::iterator spanIt;
+    };
+
+    bool isSplayRoot(uint32_t x) const {
+        uint32_t p = nodes[x].parent;
+        return p == NIL || (nodes[p].child[0] != x && nodes[p].child[1] != x);
+    }
+
+    void applyFlip(uint32_t x) {
+        Node& n = nodes[x];
+        std::swap(n.child[0], n.child[1]);
+        std::swap(n.lmax, n.rmax);
+        n.flip = !n.flip;
+    }
+
+    void pushDown(uint32_t x) {
+        Node& n = nodes[x];
+        if (!n.flip) return;
+        if (n.child[0] != NIL) applyFlip(n.child[0]);
+        if (n.child[1] != NIL) applyFlip(n.child[1]);
+        n.flip = false;
+    }
+
+    void pull(uint32_t x) {
+        Node& n = nodes[x];
+        const Node* l = n.child[0] == NIL ? nullptr : &nodes[n.child[0]];
+        const Node* r = n.child[1] == NIL ? nullptr : &nodes[n.child[1]];
+        int above = l ? (int)l->size : 0, below = r ? (int)r->size : 0;
+        n.size = above + below + 1;
+
+        // Best reaches from x into its virtual children; x itself is distance 0
+        Far self{0, x};
+        Far h1 = self, h2 = self;
+        if (!n.arms.empty()) {
+            auto it = n.arms.begin();
+            h1 = *it;
+            if (++it != n.arms.end()) h2 = *it;
+        }
+        Far up = l ? Far{l->rmax.dist + 1, l->rmax.v} : self;   // toward the segment top
+        Far down = r ? Far{r->lmax.dist + 1, r->lmax.v} : self; // toward the bottom
+
+        Far fromTop = std::max(h1, down);
+        n.lmax = {above + fromTop.dist, fromTop.v};
+        if (l) n.lmax = std::max(n.lmax, l->lmax);
+        Far fromBottom = std::max(h1, up);
+        n.rmax = {below + fromBottom.dist, fromBottom.v};
+        if (r) n.rmax = std::max(n.rmax, r->rmax);
+
+        // Longest path through x: the two longest arms in different directions
+        Far arms[4] = {h1, h2, up, down};
+        std::sort(arms, arms + 4, std::greater<Far>());
+        n.diam = {arms[0].dist + arms[1].dist, arms[0].v, arms[1].v};
+        if (l) n.diam = std::max(n.diam, l->diam);
+        if (r) n.diam = std::max(n.diam, r->diam);
+        if (!n.spans.empty()) n.diam = std::max(n.diam, *n.spans.begin());
+    }
+
+    void rotate(uint32_t x) {
+        uint32_t y = nodes[x].parent, z = nodes[y].parent;
+        int side = nodes[y].child[1] == x;
+        uint32_t moved = nodes[x].child[!side];
+        if (!isSplayRoot(y)) nodes[z].child[nodes[z].child[1] == y] = x;
+        nodes[x].parent = z;
+        nodes[x].child[!side] = y;
+        nodes[y].parent = x;
+        nodes[y].child[side] = moved;
+        if (moved != NIL) nodes[moved].parent = y;
+        pull(y);
+        pull(x);
+    }
+
+    void splay(uint32_t x) {
+        path.clear();
+        path.push_back(x);
+        for (uint32_t y = x; !isSplayRoot(y); y = nodes[y].parent) path.push_back(nodes[y].parent);
+        uint32_t root = path.back();
+        for (size_t i = path.size(); i-- > 0;) pushDown(path[i]);
+        while (!isSplayRoot(x)) {
+            uint32_t y = nodes[x].parent;
+            if (!isSplayRoot(y)) {
+                uint32_t z = nodes[y].parent;
+                bool zigzig = (nodes[z].child[1] == y) == (nodes[y].child[1] == x);
+                rotate(zigzig ? y : x);
+            }
+            rotate(x);
+        }
+        if (root != x && nodes[root].isVirtual) {
+            nodes[x].isVirtual = true;
+            nodes[x].armIt = nodes[root].armIt;
+            nodes[x].spanIt = nodes[root].spanIt;
+            nodes[root].isVirtual = false;
+        }
+    }
+
+    void addVirtual(uint32_t x, uint32_t c) {
+        Node& n = nodes[c];
+        n.armIt = nodes[x].arms.insert({n.lmax.dist + 1, n.lmax.v});
+        n.spanIt = nodes[x].spans.insert(n.diam);
+        n.isVirtual = true;
+    }
+
+    void removeVirtual(uint32_t x, uint32_t c) {
+        Node& n = nodes[c];
+        nodes[x].arms.erase(n.armIt);
+        nodes[x].spans.erase(n.spanIt);
+        n.isVirtual = false;
+    }
+
+    // Makes root .. x the preferred path; x ends as the root of its splay tree
+    void access(uint32_t x) {
+        uint32_t last = NIL;
+        for (uint32_t y = x; y != NIL; y = nodes[y].parent) {
+            splay(y);
+            uint32_t right = nodes[y].child[1];
+            if (right != NIL) addVirtual(y, right);
+            if (last != NIL) removeVirtual(y, last);
+            nodes[y].child[1] = last;
+            pull(y);
+            last = y;
+        }
+        splay(x);
+    }
+
+    void makeRoot(uint32_t x) {
+        access(x);
+        applyFlip(x);
+    }
+
+    uint32_t findRoot(uint32_t x) {
+        access(x);
+        uint32_t r = x;
+        while (true) {
+            pushDown(r);
+            if (nodes[r].child[0] == NIL) break;
+            r = nodes[r].child[0];
+        }
+        splay(r);
+        return r;
+    }
+
+    void eraseNeighbor(uint32_t v, uint32_t w) {
+        auto& adj = adjacency[v];
+        for (size_t i = 0; i < adj.size(); i++) {
+            if (adj[i] != w) continue;
+            adj[i] = adj.back();
+            adj.pop_back();
+            return;
+        }
+    }
+
+    std::vector<Node> nodes;
+    std::vector<std::vector<uint32_t>> adjacency;
+    std::vector<uint32_t> path; // splay scratch
+};
@@ -0,0 +1,238 @@
+// edge_list_parser.h
+// Parallel loader for big whitespace-separated text edge lists ("u v" or
+// "u v w" per line, as SNAP and most graph dumps ship them).
+//
+// The file is memory-mapped and cut into chunks of about CHUNK_BYTES, each
+// moved forward to the next line start, so every line belongs to exactly
+// one chunk and the chunks parse independently on the thread pool. Numbers
+// are read 8 bytes at a time: a SWAR test finds how many of the 8 bytes are
+// digits, and those digits are converted with three multiplies instead of a
+// loop with a branch per character (ids up to 10 digits take a second
+// step). Near the end of the mapping, where an 8-byte load would run past
+// it, a plain loop takes over.
+//
+// Lines starting with '#' or '%' are comments; blank lines are skipped;
+// columns after the ones asked for are ignored, and a missing weight is 1.
+// Numbers are unsigned and at most 10 digits, and ids are at most
+// MAX_VERTEX_ID so that one more than the largest (the vertex count) and
+// one more than that (the CSR offset count) fit 32 bits. Errors report the
+// line number and byte offset of the first bad line.
+//
+// loadEdgeListCsr() (graph_convert and tree_tool on unweighted lists)
+// builds the CSR straight from the per-chunk edge arrays
+// with buildCsrChunks(), a parallel counting sort (atomic degree counts,
+// prefix sum, atomic cursors to scatter), without concatenating them first.
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+
+#include "csr_graph.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+
+struct EdgeListChunk {
+    std::vector<Edge> edges;
+    std::vector<uint32_t> weights; // with weights only, one per edge
+    uint32_t maxId = 0;
+    uint64_t errorAt = UINT64_MAX; // byte offset of the first bad line
+};
+
+struct EdgeListStats {
+    uint64_t bytes = 0;
+    uint64_t edges = 0;
+    double parseSeconds = 0.0;
+    double buildSeconds = 0.0;
+};
+
+const uint64_t CHUNK_BYTES = 4 << 20;
+const uint32_t MAX_VERTEX_ID = NO_VERTEX - 2;
+
+namespace edge_list_detail {
+
+const uint64_t LOW_NIBBLES = 0x0F0F0F0F0F0F0F0FULL;
+const uint64_t HIGH_NIBBLES = 0xF0F0F0F0F0F0F0F0ULL;
+
+inline bool isDigit(char c) { return (unsigned char)(c - '0') < 10; }
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == ','; }
+
+// Number of leading digit bytes in 8 little-endian bytes (0 .. 8)
+inline int digitRun(uint64_t x) {
+    // A byte is a digit when its high nibble is 3 and its low nibble + 6
+    // does not carry into bit 4; nonzero bytes of bad mark the others
+    uint64_t bad = ((x & HIGH_NIBBLES) ^ 0x3030303030303030ULL)
+                 | (((x & LOW_NIBBLES) + 0x0606060606060606ULL) & HIGH_NIBBLES);
+    uint64_t nonzero = (((bad & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | bad) & 0x8080808080808080ULL;
+    return nonzero ? __builtin_ctzll(nonzero) >> 3 : 8;
+}
+
+// Value of the first k (1 .. 8) digit bytes of x
+inline uint64_t digitsValue(uint64_t x, int k) {
+    // Shifting the digits to the top leaves zero bytes in front: leading zeros
+    uint64_t v = (x & LOW_NIBBLES) << (8 * (8 - k));
+    v = (v * 10 + (v >> 8)) & 0x00FF00FF00FF00FFULL;
+    v = (v * 100 + (v >> 16)) & 0x0000FFFF0000FFFFULL;
+    return (v * 10000 + (v >> 32)) & 0xFFFFFFFFULL;
+}
+
+const uint64_t POWERS[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+// Parses a vertex id or weight at p; false if there is no number or it does
+// not fit in 32 bits. safe is the last position an 8-byte load may start at
+// (nullptr when the mapping is shorter than 8 bytes).
+inline bool parseNumber(const char*& p, const char* end, const char* safe, uint32_t& out) {
+    uint64_t value = 0;
+    int digits = 0;
+    while (true) {
+        if (!safe || p > safe) {
+            while (p < end && isDigit(*p) && digits <= 10) {
+                value = value * 10 + (uint64_t)(*p++ - '0');
+                digits++;
+            }
+            break;
+        }
+        uint64_t x;
+        std::memcpy(&x, p, 8);
+        int k = digitRun(x);
+        if (k == 0) break;
+        value = value * POWERS[k] + digitsValue(x, k);
+        p += k;
+        digits += k;
+        if (k < 8 || digits > 10) break;
+    }
+    if (digits == 0 || digits > 10 || value > UINT32_MAX) return false;
+    out = (uint32_t)value;
+    return true;
+}
+
+inline const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) p++;
+    return p;
+}
+
+inline const char* nextLine(const char* p, const char* end) {
+    const char* nl = (const char*)std::memchr(p, '\n', end - p);
+    return nl ? nl + 1 : end;
+}
+
+// Parses the lines in [begin, end); data .. dataEnd is the whole mapping
+inline void parseChunk(const char* data, const char* dataEnd, const char* begin, const char* end, bool weighted,
+                       EdgeListChunk& out) {
+    const char* safe = dataEnd - data >= 8 ? dataEnd - 8 : nullptr;
+    // A rough guess from the chunk size: about 12 bytes per line
+    out.edges.reserve((end - begin) / 12 + 1);
+    const char* p = begin;
+    while (p < end) {
+        const char* line = p;
+        p = skipBlanks(p, end);
+        if (p == end) break;
+        if (*p == '\n' || *p == '#' || *p == '%') {
+            p = nextLine(p, end);
+            continue;
+        }
+        uint32_t u = 0, v = 0, w = 1;
+        bool ok = parseNumber(p, end, safe, u) && p < end && isBlank(*p);
+        p = skipBlanks(p, end);
+        ok = ok && parseNumber(p, end, safe, v) && (p == end || isBlank(*p) || *p == '\n');
+        if (ok && weighted) {
+            p = skipBlanks(p, end);
+            if (p < end && isDigit(*p)) ok = parseNumber(p, end, safe, w) && (p == end || isBlank(*p) || *p == '\n');
+        }
+        if (!ok || u > MAX_VERTEX_ID || v > MAX_VERTEX_ID) {
+            out.errorAt = line - data;
+            return;
+        }
+        out.edges.push_back({u, v});
+        if (weighted) out.weights.push_back(w);
+        out.maxId = std::max(out.maxId, std::max(u, v));
+        p = nextLine(p, end);
+    }
+}
+
+} // namespace edge_list_detail
+
+// Parses the whole file on the pool into one EdgeListChunk per chunk; n is
+// one more than the largest id (0 for a file without edges)
+inline bool parseEdgeListChunks(const std::string& path, std::vector<EdgeListChunk>& chunks, uint32_t& n,
+                                ThreadPool& pool, bool weighted = false, EdgeListStats* stats = nullptr) {
+    auto started = std::chrono::steady_clock::now();
+    MappedFile file;
+    if (!file.open(path)) return false;
+    const char* data = file.data();
+    uint64_t size = file.size();
+    file.advise(0, size, MADV_SEQUENTIAL);
+
+    // Chunk c covers [cut[c], cut[c + 1]): nominal cuts moved past the next newline
+    size_t count = std::max<uint64_t>(1, (size + CHUNK_BYTES - 1) / CHUNK_BYTES);
+    std::vector<uint64_t> cut(count + 1, size);
+    cut[0] = 0;
+    for (size_t c = 1; c < count; c++) {
+        uint64_t at = std::max(cut[c - 1], c * CHUNK_BYTES - 1);
+        cut[c] = at >= size ? size : edge_list_detail::nextLine(data + at, data + size) - data;
+    }
+
+    chunks.assign(count, EdgeListChunk());
+    pool.parallelFor(count, 1, [&](size_t b, size_t e, int) {
+        for (size_t c = b; c < e; c++) {
+            edge_list_detail::parseChunk(data, data + size, data + cut[c], data + cut[c + 1], weighted, chunks[c]);
+        }
+    });
+
+    n = 0;
+    uint64_t edges = 0;
+    for (const EdgeListChunk& c : chunks) {
+        if (c.errorAt != UINT64_MAX) {
+            uint64_t line = 1;
+            for (uint64_t i = 0; i < c.errorAt; i++) line += data[i] == '\n';
+            std::cerr << path << ": bad edge at line " << line << " (byte " << c.errorAt << ")" << std::endl;
+            return false;
+        }
+        if (!c.edges.empty()) n = std::max(n, c.maxId + 1);
+        edges += c.edges.size();
+    }
+    if (stats) {
+        stats->bytes = size;
+        stats->edges = edges;
+        stats->parseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+    return true;
+}
+
+// The same, concatenated into one edge list (and weights, when given)
+inline bool parseEdgeList(const std::string& path, std::vector<Edge>& edges, std::vector<uint32_t>* weights,
+                          uint32_t& n, ThreadPool& pool, EdgeListStats* stats = nullptr) {
+    std::vector<EdgeListChunk> chunks;
+    if (!parseEdgeListChunks(path, chunks, n, pool, weights != nullptr, stats)) return false;
+    std::vector<uint64_t> at(chunks.size() + 1, 0);
+    for (size_t c = 0; c < chunks.size(); c++) at[c + 1] = at[c] + chunks[c].edges.size();
+    edges.resize(at.back());
+    if (weights) weights->resize(at.back());
+    pool.parallelFor(chunks.size(), 1, [&](size_t b, size_t e, int) {
+        for (size_t c = b; c < e; c++) {
+            std::copy(chunks[c].edges.begin(), chunks[c].edges.end(), edges.begin() + at[c]);
+            if (weights) std::copy(chunks[c].weights.begin(), chunks[c].weights.end(), weights->begin() + at[c]);
+            chunks[c] = EdgeListChunk();
+        }
+    });
+    return true;
+}
+
+// Text edge list straight to an undirected CSR graph on at least minN vertices
+inline bool loadEdgeListCsr(const std::string& path, CsrGraph& g, ThreadPool& pool, uint32_t minN = 0,
+                            EdgeListStats* stats = nullptr) {
+    std::vector<EdgeListChunk> chunks;
+    uint32_t n;
+    if (!parseEdgeListChunks(path, chunks, n, pool, false, stats)) return false;
+    auto started = std::chrono::steady_clock::now();
+    g = buildCsrChunks(std::max(n, minN), chunks.size(), [&](size_t chunk, int, auto&& fn) {
+        for (const Edge& e : chunks[chunk].edges) fn(e);
+    }, pool);
+    if (stats) stats->buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return true;
+}
@@ -0,0 +1,293 @@
+// frame_recorder.h
+// Records the visualizer's frames without stalling the render loop.
+//
+// glReadPixels writes into a ring of pixel buffer objects (PBOs), so the call
+// returns right away and the copy happens on the GPU. A PBO is only mapped
+// again RING_SIZE - 1 frames later, when that copy has long finished. The
+// pixels are then handed to a background thread that writes them to disk.
+// If that thread falls behind, the frame is dropped instead of waiting.
+//
+// Output formats:
+//   raw - one file of RGBA frames, e.g. for
+//         ffmpeg -f rawvideo -pix_fmt rgba -s WxH -r 60 -i out.rgba out.mp4
+//   png - a folder with frame_000000.png, frame_000001.png, ...
+#pragma once
+
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
+#ifndef GLFW_INCLUDE_GLEXT
+#define GLFW_INCLUDE_GLEXT
+#endif
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum CaptureFormat { CAPTURE_RAW, CAPTURE_PNG };
+
+// --- Minimal PNG writer (stored deflate blocks, no zlib needed) ---
+
+inline uint32_t pngCrc(const uint8_t* data, size_t len, uint32_t crc = 0xFFFFFFFFu) {
+    static uint32_t table[256];
+    static bool ready = false;
+    if (!ready) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        ready = true;
+    }
+    for (size_t i = 0; i < len; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+inline void pngPut32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(v >> 24); out.push_back(v >> 16); out.push_back(v >> 8); out.push_back(v);
+}
+
+inline void pngChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+    pngPut32(out, (uint32_t)data.size());
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    pngPut32(out, pngCrc(&out[start], out.size() - start) ^ 0xFFFFFFFFu);
+}
+
+// rgba is bottom-up (as glReadPixels returns it); rows are flipped here.
+inline bool writePNG(const std::string& path, const uint8_t* rgba, int width, int height) {
+    std::vector<uint8_t> raw;
+    raw.reserve((size_t)(width * 4 + 1) * height);
+    for (int y = height - 1; y >= 0; --y) {
+        raw.push_back(0); // filter: none
+        const uint8_t* row = rgba + (size_t)y * width * 4;
+        raw.insert(raw.end(), row, row + (size_t)width * 4);
+    }
+
+    std::vector<uint8_t> z = {0x78, 0x01};
+    uint32_t a = 1, b = 0;
+    for (uint8_t v : raw) { a = (a + v) % 65521; b = (b + a) % 65521; }
+    for (size_t pos = 0; pos < raw.size() || pos == 0; ) {
+        size_t len = std::min<size_t>(65535, raw.size() - pos);
+        bool last = pos + len == raw.size();
+        z.push_back(last ? 1 : 0);
+        z.push_back(len & 0xFF); z.push_back(len >> 8);
+        z.push_back(~len & 0xFF); z.push_back((~len >> 8) & 0xFF);
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+        if (last) break;
+    }
+    pngPut32(z, (b << 16) | a);
+
+    std::vector<uint8_t> ihdr;
+    pngPut32(ihdr, width);
+    pngPut32(ihdr, height);
+    ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0}); // 8 bit, RGBA, deflate, no filter, no interlace
+
+    std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    pngChunk(png, "IHDR", ihdr);
+    pngChunk(png, "IDAT", z);
+    pngChunk(png, "IEND", {});
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(png.data(), 1, png.size(), f) == png.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+// --- Recorder ---
+
+class FrameRecorder {
+public:
+    static const int RING_SIZE = 3;      // PBOs in flight
+    static const size_t POOL_SIZE = 8;   // CPU frames waiting for the encoder
+
+    ~FrameRecorder() { stop(); }
+
+    bool isRecording() const { return recording; }
+
+    // Call with the GL context current. width/height are framebuffer pixels.
+    bool start(const std::string& outPath, CaptureFormat fmt, int w, int h) {
+        if (recording) return false;
+        path = outPath;
+        format = fmt;
+        width = w;
+        height = h;
+        frameBytes = (size_t)w * h * 4;
+
+        if (format == CAPTURE_PNG) {
+            std::error_code ec;
+            std::filesystem::create_directories(path, ec);
+            if (ec) {
+                std::cerr << "recorder: cannot create " << path << ": " << ec.message() << std::endl;
+                return false;
+            }
+        } else {
+            rawFile = std::fopen(path.c_str(), "wb");
+            if (!rawFile) {
+                std::cerr << "recorder: cannot open " << path << std::endl;
+                return false;
+            }
+        }
+
+        glGenBuffers(RING_SIZE, pbos);
+        for (int i = 0; i < RING_SIZE; i++) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, NULL, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        freeFrames.assign(POOL_SIZE, std::vector<uint8_t>(frameBytes));
+        pending.clear();
+        issued = captured = written = dropped = failed = 0;
+        ringHead = 0;
+        stopping = false;
+        recording = true;
+        encoder = std::thread(&FrameRecorder::encoderLoop, this);
+        return true;
+    }
+
+    // Call after drawing and before glfwSwapBuffers.
+    void captureFrame() {
+        if (!recording) return;
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadBuffer(GL_BACK);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[ringHead]);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        issued++;
+        ringHead = (ringHead + 1) % RING_SIZE;
+        // The slot we are about to overwrite next frame was filled RING_SIZE - 1 frames ago.
+        if (issued >= RING_SIZE) collect(pbos[ringHead]);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    // Drains the PBOs still in flight, waits for the encoder and prints the stats.
+    void stop() {
+        if (!recording) return;
+        int inFlight = (int)std::min<uint64_t>(issued, RING_SIZE - 1);
+        for (int i = inFlight; i > 0; --i) {
+            collect(pbos[(ringHead + RING_SIZE - i) % RING_SIZE]);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glDeleteBuffers(RING_SIZE, pbos);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_one();
+        encoder.join();
+        if (rawFile) { std::fclose(rawFile); rawFile = nullptr; }
+        recording = false;
+
+        double dropPct = captured ? 100.0 * dropped / captured : 0.0;
+        std::cout << "recorder: " << captured << " frames captured, " << written << " written, "
+                  << dropped << " dropped (" << dropPct << "%)";
+        if (failed) std::cout << ", " << failed << " failed to write";
+        std::cout << " -> " << path << std::endl;
+    }
+
+private:
+    // Maps one PBO and queues a copy for the encoder, or drops the frame if none is free.
+    void collect(GLuint pbo) {
+        captured++;
+        std::vector<uint8_t> frame;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (freeFrames.empty()) {
+                dropped++;
+                return;
+            }
+            frame.swap(freeFrames.back());
+            freeFrames.pop_back();
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        const void* data = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (data) {
+            std::memcpy(frame.data(), data, frameBytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (data) {
+                pending.push_back(std::move(frame));
+            } else {
+                freeFrames.push_back(std::move(frame));
+                dropped++;
+            }
+        }
+        ready.notify_one();
+    }
+
+    void encoderLoop() {
+        uint64_t index = 0;
+        std::vector<uint8_t> flipped;
+        while (true) {
+            std::vector<uint8_t> frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return stopping || !pending.empty(); });
+                if (pending.empty()) return; // stopping and nothing left
+                frame.swap(pending.front());
+                pending.pop_front();
+            }
+
+            bool ok;
+            if (format == CAPTURE_PNG) {
+                char name[32];
+                std::snprintf(name, sizeof(name), "frame_%06llu.png", (unsigned long long)index);
+                ok = writePNG((std::filesystem::path(path) / name).string(), frame.data(), width, height);
+            } else {
+                size_t rowBytes = (size_t)width * 4;
+                flipped.resize(frameBytes);
+                for (int y = 0; y < height; y++) {
+                    std::memcpy(&flipped[(size_t)y * rowBytes], &frame[(size_t)(height - 1 - y) * rowBytes], rowBytes);
+                }
+                ok = std::fwrite(flipped.data(), 1, frameBytes, rawFile) == frameBytes;
+            }
+            index++;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (ok) written++; else failed++;
+            freeFrames.push_back(std::move(frame));
+        }
+    }
+
+    std::string path;
+    CaptureFormat format = CAPTURE_RAW;
+    int width = 0, height = 0;
+    size_t frameBytes = 0;
+    FILE* rawFile = nullptr;
+
+    GLuint pbos[RING_SIZE] = {};
+    int ringHead = 0;
+    bool recording = false;
+
+    // Shared with the encoder thread, guarded by mutex
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::thread encoder;
+    std::vector<std::vector<uint8_t>> freeFrames;
+    std::deque<std::vector<uint8_t>> pending;
+    bool stopping = false;
+
+    // Statistics
+    uint64_t issued = 0;   // glReadPixels calls
+    uint64_t captured = 0; // frames read back from a PBO (or dropped trying)
+    uint64_t written = 0;
+    uint64_t dropped = 0;
+    uint64_t failed = 0;
+};
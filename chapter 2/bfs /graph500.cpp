@@ -0,0 +1,359 @@
+// graph500.cpp
+// Graph500-style BFS throughput benchmark on synthetic graphs.
+//
+//   g++ -O2 -std=c++17 graph500.cpp -o graph500 -lpthread
+//   ./graph500 [--gen rmat|grid|road|powerlaw] [--scale N] [--edgefactor N] [--roots N]
+//              [--threads N] [--seed N] [--top-down] [--no-validate] [--json file]
+//              [--diameter] [--diameter-max-bfs N] [--reorder none|degree|bfs|rcm|gorder]
+//
+// Steps: generate the edge list (2^scale vertices), build the CSR graph in
+// parallel (timed as "construction"), then run BFS from --roots random
+// non-isolated roots. Every BFS tree is validated: the root is its own parent,
+// every tree edge is a graph edge, parent chains end at the root, and for
+// every graph edge both endpoints are either unreached or at depths differing
+// by at most one. Throughput is reported in traversed edges per second (TEPS)
+// with the harmonic mean over the roots, as in the Graph500 specification.
+//
+// --gen powerlaw is a Chung-Lu graph with the same vertex and edge counts
+// as rmat and degree exponent 2.5 (graph_generators.h).
+//
+// Edges are counted after self-loops and duplicates are removed, so TEPS is
+// somewhat lower than with the specification's count of raw input edges.
+//
+// --reorder renumbers the vertices after construction (graph_reorder.h,
+// timed as "reorder_time") and runs the BFS on the renumbered graph from the
+// same roots. The parent arrays are mapped back to the original ids and
+// validated against the graph as built, so the original graph is kept for
+// the run unless --no-validate. gap_bits_before / gap_bits_after show the
+// mean bits of |u - v| over the arcs.
+//
+// --diameter then computes the exact diameter of the graph's main component
+// with iFUB (graph_diameter.h), printing the bounds as they tighten;
+// --diameter-max-bfs stops it after that many BFS runs with the bounds so
+// far. On graphs up to 2^12 vertices the result is checked with a BFS from
+// every vertex.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "csr_graph.h"
+#include "graph_diameter.h"
+#include "graph_generators.h"
+#include "graph_reorder.h"
+#include "parallel_bfs.h"
+#include "thread_pool.h"
+
+struct Options {
+    std::string gen = "rmat";
+    int scale = 16;
+    int edgeFactor = 16;
+    int roots = 64;
+    int threads = 0;
+    uint64_t seed = 1;
+    bool topDownOnly = false;
+    bool validate = true;
+    std::string jsonPath;
+    bool diameter = false;
+    uint64_t diameterMaxBfs = 0;
+    VertexOrder order = ORDER_NONE;
+};
+
+const uint32_t DIAMETER_CHECK_MAX = 1 << 12;
+const double POWER_LAW_EXPONENT = 2.5;
+
+static double secondsSince(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+// --- Validation ---
+
+static bool hasEdge(const CsrGraph& g, uint32_t u, uint32_t v) {
+    return std::binary_search(g.begin(u), g.end(u), v); // buildCsr sorts every list
+}
+
+// Empty string when parent[] is a valid BFS tree of g from s.root
+static std::string validateBfs(const CsrGraph& g, const std::vector<uint32_t>& parent, const BfsSummary& s,
+                               ThreadPool& pool) {
+    if (parent[s.root] != s.root) return "root is not its own parent";
+
+    // Depths from the parent chains; a chain longer than n is a cycle
+    std::vector<uint32_t> depth(g.n, NO_VERTEX);
+    std::vector<uint32_t> chain;
+    depth[s.root] = 0;
+    uint64_t reached = 0;
+    for (uint32_t v = 0; v < g.n; v++) {
+        if (parent[v] == NO_VERTEX) continue;
+        reached++;
+        uint32_t w = v;
+        chain.clear();
+        while (depth[w] == NO_VERTEX) {
+            if (chain.size() > g.n) return "parent chain of " + std::to_string(v) + " has a cycle";
+            uint32_t p = parent[w];
+            if (p == NO_VERTEX || p >= g.n) return "vertex " + std::to_string(w) + " has an unreached parent";
+            if (!hasEdge(g, p, w)) return "tree edge " + std::to_string(p) + "-" + std::to_string(w) + " is not in the graph";
+            chain.push_back(w);
+            w = p;
+        }
+        for (size_t i = chain.size(); i-- > 0;) depth[chain[i]] = depth[parent[chain[i]]] + 1;
+    }
+    if (reached != s.reached) return "reached " + std::to_string(reached) + " vertices, BFS reported " + std::to_string(s.reached);
+    if (depth[s.root] != 0) return "root is not at depth 0";
+
+    std::vector<std::string> errors(pool.size());
+    pool.parallelFor(g.n, 4096, [&](size_t b, size_t e, int tid) {
+        for (size_t u = b; u < e && errors[tid].empty(); u++) {
+            for (const uint32_t* it = g.begin((uint32_t)u); it != g.end((uint32_t)u); ++it) {
+                uint32_t du = depth[u], dv = depth[*it];
+                bool bad = (du == NO_VERTEX) != (dv == NO_VERTEX)
+                        || (du != NO_VERTEX && (du > dv + 1 || dv > du + 1));
+                if (bad) {
+                    errors[tid] = "edge " + std::to_string(u) + "-" + std::to_string(*it) + " spans depths "
+                                + std::to_string((int64_t)du) + " and " + std::to_string((int64_t)dv);
+                    break;
+                }
+            }
+        }
+    });
+    for (const auto& err : errors) {
+        if (!err.empty()) return err;
+    }
+    return "";
+}
+
+// Largest eccentricity over the component of `inside`, by BFS from every vertex
+static uint32_t bruteForceDiameter(const CsrGraph& g, uint32_t inside, ThreadPool& pool) {
+    ParallelBfs bfs(g, pool);
+    std::vector<uint32_t> parent, component;
+    bfs.run(inside, component);
+    uint32_t best = 0;
+    for (uint32_t v = 0; v < g.n; v++) {
+        if (component[v] == NO_VERTEX) continue;
+        best = std::max(best, bfs.run(v, parent).levels - 1);
+    }
+    return best;
+}
+
+// perm, when the graph was renumbered, maps the endpoints back to original ids
+static int runDiameter(const CsrGraph& g, const Options& opt, ThreadPool& pool, const VertexPermutation* perm) {
+    double lastPrint = -1.0;
+    auto progress = [&](const DiameterProgress& p) {
+        if (p.seconds - lastPrint >= 1.0) {
+            std::printf("  diameter progress: %.1fs bfs=%llu level=%u lower=%u upper=%s\n", p.seconds,
+                        (unsigned long long)p.bfsRuns, p.level, p.lower,
+                        p.upper == NO_VERTEX ? "?" : std::to_string(p.upper).c_str());
+            std::fflush(stdout);
+            lastPrint = p.seconds;
+        }
+        return true;
+    };
+    GraphDiameter d = graphDiameter(g, pool, progress, opt.diameterMaxBfs);
+    uint32_t a = perm ? perm->toOld(d.a) : d.a, b = perm ? perm->toOld(d.b) : d.b;
+    std::printf("diameter_lower: %u\ndiameter_upper: %s\ndiameter_exact: %d\ndiameter_endpoints: %u %u\n"
+                "diameter_bfs_runs: %llu\ndiameter_seconds: %.6g\n",
+                d.lower, d.upper == NO_VERTEX ? "?" : std::to_string(d.upper).c_str(), d.exact ? 1 : 0, a, b,
+                (unsigned long long)d.bfsRuns, d.seconds);
+    if (d.exact && g.n <= DIAMETER_CHECK_MAX) {
+        uint32_t expected = bruteForceDiameter(g, d.center, pool);
+        if (expected != d.lower) {
+            std::cerr << "diameter " << d.lower << ", by BFS from every vertex " << expected << std::endl;
+            return 1;
+        }
+        std::printf("diameter_check: passed\n");
+    }
+    return 0;
+}
+
+// --- Statistics ---
+
+struct Quartiles {
+    double min, q1, median, q3, max, mean, stddev;
+};
+
+static Quartiles quartiles(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    auto at = [&](double q) {
+        double pos = q * (v.size() - 1);
+        size_t i = (size_t)pos;
+        return i + 1 < v.size() ? v[i] + (pos - i) * (v[i + 1] - v[i]) : v[i];
+    };
+    Quartiles r{v.front(), at(0.25), at(0.5), at(0.75), v.back(), 0.0, 0.0};
+    for (double x : v) r.mean += x;
+    r.mean /= v.size();
+    for (double x : v) r.stddev += (x - r.mean) * (x - r.mean);
+    r.stddev = v.size() > 1 ? std::sqrt(r.stddev / (v.size() - 1)) : 0.0;
+    return r;
+}
+
+static double harmonicMean(const std::vector<double>& v) {
+    double inv = 0.0;
+    for (double x : v) inv += 1.0 / x;
+    return v.size() / inv;
+}
+
+static void printQuartiles(const char* name, const Quartiles& q) {
+    std::printf("min_%s: %.6g\nfirstquartile_%s: %.6g\nmedian_%s: %.6g\nthirdquartile_%s: %.6g\nmax_%s: %.6g\n"
+                "mean_%s: %.6g\nstddev_%s: %.6g\n",
+                name, q.min, name, q.q1, name, q.median, name, q.q3, name, q.max, name, q.mean, name, q.stddev);
+}
+
+// --- Main ---
+
+static bool parseArgs(int argc, char** argv, Options& o) {
+    for (int i = 1; i < argc; i++) {
+        bool more = i + 1 < argc;
+        if (std::strcmp(argv[i], "--gen") == 0 && more) o.gen = argv[++i];
+        else if (std::strcmp(argv[i], "--scale") == 0 && more) o.scale = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--edgefactor") == 0 && more) o.edgeFactor = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--roots") == 0 && more) o.roots = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--threads") == 0 && more) o.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--seed") == 0 && more) o.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--top-down") == 0) o.topDownOnly = true;
+        else if (std::strcmp(argv[i], "--no-validate") == 0) o.validate = false;
+        else if (std::strcmp(argv[i], "--json") == 0 && more) o.jsonPath = argv[++i];
+        else if (std::strcmp(argv[i], "--diameter") == 0) o.diameter = true;
+        else if (std::strcmp(argv[i], "--diameter-max-bfs") == 0 && more) {
+            o.diameter = true;
+            o.diameterMaxBfs = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--reorder") == 0 && more) {
+            if (!parseOrder(argv[++i], o.order)) return false;
+        }
+        else return false;
+    }
+    return (o.gen == "rmat" || o.gen == "grid" || o.gen == "road" || o.gen == "powerlaw") && o.scale >= 1
+        && o.scale <= 31 && o.edgeFactor >= 1 && o.roots >= 1;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::cerr << "usage: " << argv[0] << " [--gen rmat|grid|road|powerlaw] [--scale N] [--edgefactor N] [--roots N]"
+                  << " [--threads N] [--seed N] [--top-down] [--no-validate] [--json file]"
+                  << " [--diameter] [--diameter-max-bfs N] [--reorder none|degree|bfs|rcm|gorder]" << std::endl;
+        return 2;
+    }
+    ThreadPool pool(opt.threads);
+
+    auto t = std::chrono::steady_clock::now();
+    uint32_t n = uint32_t(1) << opt.scale;
+    std::vector<Edge> edges;
+    if (opt.gen == "rmat") {
+        edges = rmatEdges(opt.scale, opt.edgeFactor, opt.seed, pool);
+    } else if (opt.gen == "powerlaw") {
+        edges = collectEdges(powerLawSource(n, 2.0 * opt.edgeFactor, POWER_LAW_EXPONENT, opt.seed), pool);
+    } else {
+        uint32_t width = uint32_t(1) << ((opt.scale + 1) / 2), height = n / width;
+        edges = opt.gen == "grid" ? gridEdges(width, height, pool) : roadEdges(width, height, 0.1, 0.02, opt.seed, pool);
+    }
+    double generationTime = secondsSince(t);
+
+    t = std::chrono::steady_clock::now();
+    CsrGraph g = buildCsr(n, edges, pool);
+    double constructionTime = secondsSince(t);
+    std::vector<Edge>().swap(edges);
+
+    // Distinct roots with at least one edge
+    std::vector<uint32_t> roots;
+    SplitMix64 rng(opt.seed ^ 0x7007ULL);
+    std::vector<unsigned char> picked(n, 0);
+    uint64_t candidates = 0;
+    for (uint32_t v = 0; v < n; v++) candidates += g.degree(v) > 0;
+    while ((int)roots.size() < opt.roots && roots.size() < candidates) {
+        uint32_t v = (uint32_t)rng.below(n);
+        if (g.degree(v) == 0 || picked[v]) continue;
+        picked[v] = 1;
+        roots.push_back(v);
+    }
+    if (roots.empty()) {
+        std::cerr << "graph has no edges" << std::endl;
+        return 1;
+    }
+
+    // Roots stay in original ids; the BFS runs on the renumbered graph when reordering
+    bool reordered = opt.order != ORDER_NONE;
+    CsrGraph built;
+    VertexPermutation perm;
+    double reorderTime = 0.0, gapBefore = meanGapBits(g), gapAfter = gapBefore;
+    if (reordered) {
+        t = std::chrono::steady_clock::now();
+        perm = vertexOrder(g, opt.order);
+        CsrGraph renumbered = permuteCsr(g, perm);
+        reorderTime = secondsSince(t);
+        if (opt.validate) built = std::move(g);
+        g = std::move(renumbered);
+        gapAfter = meanGapBits(g);
+    }
+    const CsrGraph& original = reordered && opt.validate ? built : g;
+
+    ParallelBfs bfs(g, pool);
+    bfs.setDirectionOptimizing(!opt.topDownOnly);
+    std::vector<uint32_t> parent, originalParent;
+    std::vector<double> times, teps, edgeCounts;
+    double validationTime = 0.0;
+    for (uint32_t root : roots) {
+        BfsSummary s = bfs.run(reordered ? perm.rank[root] : root, parent);
+        times.push_back(s.seconds);
+        edgeCounts.push_back((double)s.edges);
+        teps.push_back(s.seconds > 0.0 ? s.edges / s.seconds : 0.0);
+        if (!opt.validate) continue;
+        auto v = std::chrono::steady_clock::now();
+        if (reordered) {
+            unpermuteVertices(perm, parent, originalParent);
+            parent.swap(originalParent);
+            s.root = root;
+        }
+        std::string err = validateBfs(original, parent, s, pool);
+        validationTime += secondsSince(v);
+        if (!err.empty()) {
+            std::cerr << "validation failed for root " << root << ": " << err << std::endl;
+            return 1;
+        }
+    }
+
+    Quartiles tq = quartiles(times), eq = quartiles(edgeCounts), sq = quartiles(teps);
+    double hmean = harmonicMean(teps);
+    std::printf("generator: %s\nSCALE: %d\nedgefactor: %d\nNBFS: %zu\nthreads: %d\ndirection_optimizing: %d\n",
+                opt.gen.c_str(), opt.scale, opt.edgeFactor, roots.size(), pool.size(), opt.topDownOnly ? 0 : 1);
+    std::printf("num_vertices: %u\nnum_edges: %llu\ngraph_bytes: %zu\n",
+                g.n, (unsigned long long)(g.arcs() / 2), g.bytes());
+    std::printf("generation_time: %.6g\nconstruction_time: %.6g\nvalidation: %s\nvalidation_time: %.6g\n",
+                generationTime, constructionTime, opt.validate ? "passed" : "skipped", validationTime);
+    std::printf("reorder: %s\nreorder_time: %.6g\ngap_bits_before: %.3f\ngap_bits_after: %.3f\n",
+                orderName(opt.order), reorderTime, gapBefore, gapAfter);
+    printQuartiles("time", tq);
+    printQuartiles("nedge", eq);
+    printQuartiles("TEPS", sq);
+    std::printf("harmonic_mean_TEPS: %.6g\n", hmean);
+
+    if (!opt.jsonPath.empty()) {
+        std::ofstream out(opt.jsonPath);
+        if (!out) {
+            std::cerr << "Failed to write " << opt.jsonPath << std::endl;
+            return 1;
+        }
+        out << "{\n  \"generator\": \"" << opt.gen << "\",\n  \"scale\": " << opt.scale
+            << ",\n  \"edgefactor\": " << opt.edgeFactor << ",\n  \"threads\": " << pool.size()
+            << ",\n  \"vertices\": " << g.n << ",\n  \"edges\": " << g.arcs() / 2
+            << ",\n  \"construction_seconds\": " << constructionTime
+            << ",\n  \"reorder\": \"" << orderName(opt.order) << "\",\n  \"reorder_seconds\": " << reorderTime
+            << ",\n  \"validated\": " << (opt.validate ? "true" : "false")
+            << ",\n  \"harmonic_mean_teps\": " << hmean
+            << ",\n  \"median_seconds\": " << tq.median << ",\n  \"roots\": [\n";
+        for (size_t i = 0; i < roots.size(); i++) {
+            out << "    {\"root\": " << roots[i] << ", \"seconds\": " << times[i] << ", \"edges\": "
+                << (uint64_t)edgeCounts[i] << ", \"teps\": " << teps[i] << "}" << (i + 1 < roots.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        std::cout << "wrote " << opt.jsonPath << std::endl;
+    }
+    if (opt.diameter) return runDiameter(g, opt, pool, reordered ? &perm : nullptr);
+    return 0;
+}
@@ -0,0 +1,300 @@
+// graph_convert.cpp
+// Converts edge lists into the memory-mapped CSR format of graph_file.h, and
+// opens such files to run BFS on them in place.
+//
+//   g++ -O2 -std=c++17 graph_convert.cpp -o graph_convert -lpthread
+//   ./graph_convert --in edges.txt|file.edges --out graph.csr [--nodes N] [--weighted]
+//                   [--coords xy.txt] [--compact] [--threads N] [--check]
+//   ./graph_convert --info graph.csr [--roots N] [--seed N] [--access bfs|scan|preload] [--check]
+//                   [--compress] [--threads N]
+//
+// --in takes a text edge list ("u v" per line, "u v w" with --weighted; a
+// missing weight is 1; '#' and '%' lines are comments) or a binary edge file
+// from graph_gen --out, told apart by its magic. Text is parsed in parallel
+// (edge_list_parser.h) and its throughput printed as parse_mb_per_s. The
+// graph is built undirected, without self-loops or duplicate edges (the
+// lightest duplicate is kept), on --nodes vertices or one more than the
+// largest id. --coords adds an "x y" line per vertex.
+// --compact stores 32-bit offsets (graphs under 2^32 arcs). --check maps the
+// written file again and compares it with the graph in memory.
+//
+// --info maps a graph file and prints its header, how long the mapping took
+// and, with --roots N, the time of a BFS from N random non-isolated vertices
+// run straight on the mapping (csr_bfs.h over a CsrView). --access picks the
+// madvise hints; --check also scans the arrays for bad offsets and targets.
+// --compress encodes the graph with compressed_csr.h, prints its size next
+// to the plain offsets and targets, and runs every BFS on both, failing if
+// they disagree.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "csr_bfs.h"
+#include "compressed_csr.h"
+#include "csr_graph.h"
+#include "edge_list_parser.h"
+#include "graph_file.h"
+#include "graph_generators.h"
+#include "thread_pool.h"
+
+struct Options {
+    std::string in, out, info, coords;
+    uint32_t nodes = 0;
+    bool weighted = false;
+    bool compact = false;
+    bool check = false;
+    bool compress = false;
+    int roots = 0;
+    uint64_t seed = 1;
+    GraphAccess access = GRAPH_ACCESS_BFS;
+    int threads = 0;
+};
+
+const int ROOT_TRIES = 64; // redraws of an isolated BFS root
+
+static double secondsSince(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+static bool loadCoords(const std::string& path, uint32_t n, std::vector<float>& coords) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    float x, y;
+    while (coords.size() < 2 * (size_t)n && in >> x >> y) {
+        coords.push_back(x);
+        coords.push_back(y);
+    }
+    if (coords.size() != 2 * (size_t)n) {
+        std::cerr << path << ": " << coords.size() / 2 << " coordinates for " << n << " vertices" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template <typename Offset>
+static bool sameAsView(const BasicCsrGraph<Offset>& g, const CsrView<Offset>& v) {
+    return v.n == g.n && v.arcs() == g.arcs()
+        && std::equal(g.offsets.begin(), g.offsets.end(), v.offsets)
+        && std::equal(g.targets.begin(), g.targets.end(), v.targets)
+        && (g.weighted() ? v.weights && std::equal(g.weights.begin(), g.weights.end(), v.weights) : !v.weights);
+}
+
+template <typename Offset>
+static bool writeAndCheck(const Options& opt, const BasicCsrGraph<Offset>& g, const std::vector<float>* coords) {
+    auto t = std::chrono::steady_clock::now();
+    if (!writeGraphFile(opt.out, g, coords)) return false;
+    std::printf("write_seconds: %.6f\n", secondsSince(t));
+    if (!opt.check) return true;
+    MappedGraph mapped;
+    CsrView<Offset> view;
+    if (!mapped.open(opt.out, GRAPH_ACCESS_SCAN) || !mapped.view(view) || !sameAsView(g, view)
+        || (coords && !std::equal(coords->begin(), coords->end(), view.coords))) {
+        std::cerr << opt.out << " differs from the converted graph" << std::endl;
+        return false;
+    }
+    std::printf("check: passed\n");
+    return true;
+}
+
+static int runConvert(const Options& opt, ThreadPool& pool) {
+    std::vector<Edge> edges;
+    std::vector<uint32_t> weights;
+    uint32_t n = 0;
+    auto t = std::chrono::steady_clock::now();
+    bool binary = isEdgeFile(opt.in);
+    if (binary && opt.weighted) {
+        std::cerr << "binary edge files have no weights" << std::endl;
+        return 1;
+    }
+    // An unweighted text list goes straight from the parsed chunks to the
+    // CSR; the others are gathered into one edge list first
+    CsrGraph g;
+    EdgeListStats stats;
+    double loadTime, buildTime = 0.0;
+    bool direct = !binary && !opt.weighted;
+    if (direct) {
+        if (!loadEdgeListCsr(opt.in, g, pool, 0, &stats)) return 1;
+        loadTime = stats.parseSeconds;
+        buildTime = stats.buildSeconds;
+        n = g.n;
+    } else {
+        bool loaded = binary ? readEdgeFile(opt.in, edges, n) : parseEdgeList(opt.in, edges, &weights, n, pool, &stats);
+        if (!loaded) return 1;
+        loadTime = secondsSince(t);
+        stats.edges = edges.size();
+    }
+    if (opt.nodes && opt.nodes < n) {
+        std::cerr << "--nodes " << opt.nodes << " is below the largest id + 1 (" << n << ")" << std::endl;
+        return 1;
+    }
+    if (!binary) std::printf("parse_mb_per_s: %.1f\n", stats.bytes / 1e6 / std::max(stats.parseSeconds, 1e-9));
+    if (direct) {
+        // Isolated vertices up to --nodes
+        if (opt.nodes > g.n) {
+            g.offsets.resize((size_t)opt.nodes + 1, g.offsets.back());
+            g.n = opt.nodes;
+        }
+    } else {
+        n = std::max(n, opt.nodes);
+        t = std::chrono::steady_clock::now();
+        g = opt.weighted ? buildWeightedCsr(n, edges, weights, pool) : buildCsr(n, edges, pool);
+        buildTime = secondsSince(t);
+    }
+    std::printf("input: %s\nvertices: %u\nedges_read: %llu\narcs: %llu\n", binary ? "binary" : "text", g.n,
+                (unsigned long long)stats.edges, (unsigned long long)g.arcs());
+    std::printf("load_seconds: %.6f\nbuild_seconds: %.6f\n", loadTime, buildTime);
+    edges = std::vector<Edge>();
+    weights = std::vector<uint32_t>();
+
+    std::vector<float> coords;
+    if (!opt.coords.empty() && !loadCoords(opt.coords, g.n, coords)) return 1;
+    const std::vector<float>* xy = opt.coords.empty() ? nullptr : &coords;
+    if (opt.compact) {
+        CompactCsrGraph small;
+        if (!compactCsr(g, small)) return 1;
+        g = CsrGraph();
+        if (!writeAndCheck(opt, small, xy)) return 1;
+    } else if (!writeAndCheck(opt, g, xy)) {
+        return 1;
+    }
+    std::ifstream written(opt.out, std::ios::binary | std::ios::ate);
+    std::printf("file_bytes: %lld\n", (long long)written.tellg());
+    return 0;
+}
+
+// BFS from --roots random roots on the mapping and, with --compress, on its
+// compressed copy, which has to reach as many vertices in as many levels
+template <typename Offset, typename PackedOffset>
+static int timeBfs(const MappedGraph& mapped, const Options& opt, ThreadPool& pool) {
+    CsrView<Offset> view;
+    mapped.view(view);
+    BasicCompressedCsrGraph<PackedOffset> packed;
+    CsrBfs<BasicCompressedCsrGraph<PackedOffset>> packedBfs;
+    if (opt.compress) {
+        auto t = std::chrono::steady_clock::now();
+        if (!compressCsr(view, packed, pool)) return 1;
+        double compressTime = secondsSince(t);
+        uint64_t plain = ((uint64_t)view.n + 1) * sizeof(Offset) + view.arcs() * sizeof(uint32_t);
+        std::printf("compress_seconds: %.6f\nplain_bytes: %llu\ncompressed_bytes: %zu\ncompression_ratio: %.2f\n",
+                    compressTime, (unsigned long long)plain, packed.bytes(), (double)plain / packed.bytes());
+        packedBfs.reset(packed);
+    }
+    CsrBfs<CsrView<Offset>> bfs(view);
+    SplitMix64 rng(opt.seed);
+    double total = 0.0, packedTotal = 0.0;
+    for (int r = 0; r < opt.roots; r++) {
+        uint32_t root = (uint32_t)rng.below(view.n);
+        for (int tries = 0; tries < ROOT_TRIES && view.degree(root) == 0; tries++) root = (uint32_t)rng.below(view.n);
+        uint32_t levels;
+        auto t = std::chrono::steady_clock::now();
+        bfs.run(root, levels);
+        double secs = secondsSince(t);
+        total += secs;
+        std::printf("bfs root %u: reached %zu, levels %u, %.6f s", root, bfs.reachedCount(), levels, secs);
+        if (opt.compress) {
+            uint32_t packedLevels;
+            t = std::chrono::steady_clock::now();
+            packedBfs.run(root, packedLevels);
+            secs = secondsSince(t);
+            packedTotal += secs;
+            std::printf(", compressed %.6f s", secs);
+            if (packedBfs.reachedCount() != bfs.reachedCount() || packedLevels != levels) {
+                std::printf("\n");
+                std::cerr << "compressed BFS reached " << packedBfs.reachedCount() << " in " << packedLevels
+                          << " levels" << std::endl;
+                return 1;
+            }
+        }
+        std::printf("\n");
+    }
+    std::printf("bfs_seconds: %.6f\n", total);
+    if (opt.compress && opt.roots > 0) {
+        std::printf("bfs_compressed_seconds: %.6f\ncompressed_relative_speed: %.3f\n", packedTotal,
+                    total / std::max(packedTotal, 1e-9));
+    }
+    return 0;
+}
+
+// Whether the compressed lists of h's graph surely fit 32-bit offsets: a
+// list takes at most 10 bytes plus 4.25 per arc
+static bool compressedFits32(const GraphFileHeader& h) {
+    return 10 * (uint64_t)h.n + 5 * h.arcs + DECODE_PADDING <= UINT32_MAX;
+}
+
+static int runInfo(const Options& opt, ThreadPool& pool) {
+    MappedGraph mapped;
+    auto t = std::chrono::steady_clock::now();
+    if (!mapped.open(opt.info, opt.access)) return 1;
+    double openTime = secondsSince(t);
+    const GraphFileHeader& h = mapped.header();
+    std::printf("version: %u\nvertices: %u\narcs: %llu\noffset_bits: %d\nweights: %s\ncoords: %s\n"
+                "file_bytes: %llu\nopen_seconds: %.6f\n",
+                h.version, h.n, (unsigned long long)h.arcs, mapped.compactOffsets() ? 32 : 64,
+                h.flags & GRAPH_HAS_WEIGHTS ? "yes" : "no", h.flags & GRAPH_HAS_COORDS ? "yes" : "no",
+                (unsigned long long)mapped.mappedBytes(), openTime);
+    if (opt.check) {
+        t = std::chrono::steady_clock::now();
+        if (!mapped.check()) return 1;
+        std::printf("check: passed\ncheck_seconds: %.6f\n", secondsSince(t));
+    }
+    if ((opt.roots > 0 || opt.compress) && h.n > 0) {
+        bool small = compressedFits32(h);
+        if (mapped.compactOffsets()) return small ? timeBfs<uint32_t, uint32_t>(mapped, opt, pool)
+                                                  : timeBfs<uint32_t, uint64_t>(mapped, opt, pool);
+        return small ? timeBfs<uint64_t, uint32_t>(mapped, opt, pool) : timeBfs<uint64_t, uint64_t>(mapped, opt, pool);
+    }
+    return 0;
+}
+
+static bool parseArgs(int argc, char** argv, Options& o) {
+    for (int i = 1; i < argc; i++) {
+        bool more = i + 1 < argc;
+        if (std::strcmp(argv[i], "--in") == 0 && more) o.in = argv[++i];
+        else if (std::strcmp(argv[i], "--out") == 0 && more) o.out = argv[++i];
+        else if (std::strcmp(argv[i], "--info") == 0 && more) o.info = argv[++i];
+        else if (std::strcmp(argv[i], "--coords") == 0 && more) o.coords = argv[++i];
+        else if (std::strcmp(argv[i], "--nodes") == 0 && more) o.nodes = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--weighted") == 0) o.weighted = true;
+        else if (std::strcmp(argv[i], "--compact") == 0) o.compact = true;
+        else if (std::strcmp(argv[i], "--check") == 0) o.check = true;
+        else if (std::strcmp(argv[i], "--compress") == 0) o.compress = true;
+        else if (std::strcmp(argv[i], "--roots") == 0 && more) o.roots = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--seed") == 0 && more) o.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--threads") == 0 && more) o.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--access") == 0 && more) {
+            std::string a = argv[++i];
+            if (a == "bfs") o.access = GRAPH_ACCESS_BFS;
+            else if (a == "scan") o.access = GRAPH_ACCESS_SCAN;
+            else if (a == "preload") o.access = GRAPH_ACCESS_PRELOAD;
+            else return false;
+        } else {
+            return false;
+        }
+    }
+    bool convert = !o.in.empty() && !o.out.empty();
+    return convert != !o.info.empty() && o.nodes != NO_VERTEX && o.roots >= 0;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::cerr << "usage: " << argv[0] << " --in edges.txt|file.edges --out graph.csr [--nodes N] [--weighted]"
+                  << " [--coords xy.txt] [--compact] [--threads N] [--check]\n"
+                  << "       " << argv[0] << " --info graph.csr [--roots N] [--seed N]"
+                  << " [--access bfs|scan|preload] [--check] [--compress] [--threads N]" << std::endl;
+        return 2;
+    }
+    ThreadPool pool(opt.threads);
+    if (!opt.info.empty()) return runInfo(opt, pool);
+    return runConvert(opt, pool);
+}
@@ -0,0 +1,263 @@
+// graph_editor.h
+// Editing core for the tree_diameter.py canvas: nodes with positions, an
+// undirected edge set, picking by position and deletion, all independent of
+// the number of nodes on screen.
+//
+// Picking uses a uniform grid of square cells (hashed, so the canvas has no
+// bounds) with side 2 * radius: a node within radius of a point lies in the
+// point's cell or one of its 8 neighbors, so nodeAt() looks at the nodes of
+// 9 cells instead of hypot() over every node as get_node_at_pos does.
+//
+// Every edge knows its slot in both endpoints' adjacency lists and every
+// node its slot in its grid cell, so removal is a swap with the last entry
+// and one back-pointer fix: removing an edge is O(1) after finding it
+// (O(degree)), removing a node is O(degree), instead of scanning the whole
+// edge list. Edges are kept dense for drawing; node ids stay stable and
+// deleted ids are reused by later addNode() calls.
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "csr_graph.h"
+
+struct EditorEdge {
+    uint32_t u, v;
+    uint32_t slotU, slotV; // positions in u's and v's adjacency lists
+};
+
+class GraphEditor {
+public:
+    explicit GraphEditor(float nodeRadius = 15.0f) : radius(nodeRadius), cellSize(2.0f * nodeRadius) {}
+
+    // New node at (x, y); reuses a deleted id when there is one
+    uint32_t addNode(float x, float y) {
+        uint32_t id;
+        if (!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+        } else {
+            id = (uint32_t)nodes.size();
+            nodes.emplace_back();
+            adjacency.emplace_back();
+        }
+        Node& n = nodes[id];
+        n.x = x;
+        n.y = y;
+        n.alive = true;
+        insertIntoCell(id);
+        live++;
+        return id;
+    }
+
+    void moveNode(uint32_t id, float x, float y) {
+        Node& n = nodes[id];
+        uint64_t cell = cellKey(x, y);
+        if (cell != n.cell) {
+            eraseFromCell(id);
+            n.x = x;
+            n.y = y;
+            insertIntoCell(id);
+        } else {
+            n.x = x;
+            n.y = y;
+        }
+    }
+
+    // Removes the node and its edges in O(degree); the id becomes free
+    void removeNode(uint32_t id) {
+        if (!isAlive(id)) return;
+        while (!adjacency[id].empty()) eraseEdge(adjacency[id].back().edge);
+        eraseFromCell(id);
+        nodes[id].alive = false;
+        freeIds.push_back(id);
+        live--;
+    }
+
+    // false for self-loops, dead nodes and edges that already exist
+    bool addEdge(uint32_t u, uint32_t v) {
+        if (u == v || !isAlive(u) || !isAlive(v) || findEdge(u, v) != NO_VERTEX) return false;
+        uint32_t e = (uint32_t)edges.size();
+        edges.push_back({u, v, (uint32_t)adjacency[u].size(), (uint32_t)adjacency[v].size()});
+        adjacency[u].push_back({v, e});
+        adjacency[v].push_back({u, e});
+        return true;
+    }
+
+    bool removeEdge(uint32_t u, uint32_t v) {
+        if (!isAlive(u) || !isAlive(v)) return false;
+        uint32_t e = findEdge(u, v);
+        if (e == NO_VERTEX) return false;
+        eraseEdge(e);
+        return true;
+    }
+
+    // Index into edges() of u-v, NO_VERTEX if absent; scans the smaller list
+    uint32_t findEdge(uint32_t u, uint32_t v) const {
+        if (adjacency[u].size() > adjacency[v].size()) std::swap(u, v);
+        for (const Neighbor& a : adjacency[u]) {
+            if (a.node == v) return a.edge;
+        }
+        return NO_VERTEX;
+    }
+
+    // Closest node whose circle contains (x, y), NO_VERTEX if none
+    uint32_t nodeAt(float x, float y) const {
+        int64_t cx = cellCoord(x), cy = cellCoord(y);
+        uint32_t best = NO_VERTEX;
+        float bestDist = radius * radius;
+        for (int64_t gx = cx - 1; gx <= cx + 1; gx++) {
+            for (int64_t gy = cy - 1; gy <= cy + 1; gy++) {
+                auto it = cells.find(packCell(gx, gy));
+                if (it == cells.end()) continue;
+                for (uint32_t id : it->second) {
+                    float dx = nodes[id].x - x, dy = nodes[id].y - y;
+                    float d = dx * dx + dy * dy;
+                    if (d < bestDist || (d == bestDist && id < best)) {
+                        best = id;
+                        bestDist = d;
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+    // Appends the nodes whose centers lie in [x0, x1] x [y0, y1] (the visible
+    // part of the canvas, say)
+    void nodesIn(float x0, float y0, float x1, float y1, std::vector<uint32_t>& out) const {
+        int64_t cx0 = cellCoord(x0), cx1 = cellCoord(x1), cy0 = cellCoord(y0), cy1 = cellCoord(y1);
+        if ((cx1 - cx0 + 1) * (cy1 - cy0 + 1) > (int64_t)cells.size()) {
+            // A view wider than the occupied cells: walking the cells is cheaper
+            for (const auto& cell : cells) appendInside(cell.second, x0, y0, x1, y1, out);
+            return;
+        }
+        for (int64_t gx = cx0; gx <= cx1; gx++) {
+            for (int64_t gy = cy0; gy <= cy1; gy++) {
+                auto it = cells.find(packCell(gx, gy));
+                if (it != cells.end()) appendInside(it->second, x0, y0, x1, y1, out);
+            }
+        }
+    }
+
+    bool isAlive(uint32_t id) const { return id < nodes.size() && nodes[id].alive; }
+    float nodeX(uint32_t id) const { return nodes[id].x; }
+    float nodeY(uint32_t id) const { return nodes[id].y; }
+    float nodeRadius() const { return radius; }
+    uint32_t nodeCount() const { return live; }
+    uint32_t idBound() const { return (uint32_t)nodes.size(); } // ids are below this
+    size_t degree(uint32_t id) const { return adjacency[id].size(); }
+    uint32_t neighbor(uint32_t id, size_t i) const { return adjacency[id][i].node; }
+    const std::vector<EditorEdge>& edgeList() const { return edges; }
+
+    // The current graph over ids 0 .. idBound()-1 (deleted ids are isolated)
+    CsrGraph toCsr(ThreadPool& pool) const {
+        std::vector<Edge> list(edges.size());
+        for (size_t i = 0; i < edges.size(); i++) list[i] = {edges[i].u, edges[i].v};
+        return buildCsr(idBound(), list, pool);
+    }
+
+    // Checks every back-pointer; for tests and --verify
+    bool consistent() const {
+        uint32_t alive = 0;
+        for (uint32_t id = 0; id < nodes.size(); id++) {
+            const Node& n = nodes[id];
+            if (!n.alive) {
+                if (!adjacency[id].empty()) return false;
+                continue;
+            }
+            alive++;
+            auto it = cells.find(n.cell);
+            if (n.cell != cellKey(n.x, n.y) || it == cells.end() || it->second.size() <= n.slot
+                || it->second[n.slot] != id) {
+                return false;
+            }
+            for (size_t i = 0; i < adjacency[id].size(); i++) {
+                const Neighbor& a = adjacency[id][i];
+                const EditorEdge& e = edges[a.edge];
+                bool mine = (e.u == id && e.v == a.node && e.slotU == i) || (e.v == id && e.u == a.node && e.slotV == i);
+                if (!mine) return false;
+            }
+        }
+        size_t inCells = 0;
+        for (const auto& cell : cells) inCells += cell.second.size();
+        return alive == live && inCells == live && freeIds.size() == nodes.size() - live;
+    }
+
+private:
+    struct Node {
+        float x = 0.0f, y = 0.0f;
+        uint64_t cell = 0;
+        uint32_t slot = 0; // position in the cell's list
+        bool alive = false;
+    };
+    struct Neighbor {
+        uint32_t node;
+        uint32_t edge; // index into edges
+    };
+
+    int64_t cellCoord(float c) const { return (int64_t)std::floor(c / cellSize); }
+    static uint64_t packCell(int64_t cx, int64_t cy) { return (uint64_t)(uint32_t)cx << 32 | (uint32_t)cy; }
+    uint64_t cellKey(float x, float y) const { return packCell(cellCoord(x), cellCoord(y)); }
+
+    void insertIntoCell(uint32_t id) {
+        Node& n = nodes[id];
+        n.cell = cellKey(n.x, n.y);
+        auto& list = cells[n.cell];
+        n.slot = (uint32_t)list.size();
+        list.push_back(id);
+    }
+
+    void eraseFromCell(uint32_t id) {
+        auto it = cells.find(nodes[id].cell);
+        auto& list = it->second;
+        uint32_t slot = nodes[id].slot;
+        list[slot] = list.back();
+        nodes[list[slot]].slot = slot;
+        list.pop_back();
+        if (list.empty()) cells.erase(it);
+    }
+
+    // Swap-removes adjacency entry `slot` of node id, fixing the moved entry's edge
+    void eraseSlot(uint32_t id, uint32_t slot) {
+        auto& adj = adjacency[id];
+        adj[slot] = adj.back();
+        adj.pop_back();
+        if (slot == adj.size()) return;
+        EditorEdge& moved = edges[adj[slot].edge];
+        (moved.u == id ? moved.slotU : moved.slotV) = slot;
+    }
+
+    void eraseEdge(uint32_t e) {
+        EditorEdge dead = edges[e];
+        eraseSlot(dead.u, dead.slotU);
+        eraseSlot(dead.v, dead.slotV);
+        // Keep edges dense: the last edge takes index e
+        uint32_t last = (uint32_t)edges.size() - 1;
+        if (e != last) {
+            const EditorEdge& m = edges[last];
+            adjacency[m.u][m.slotU].edge = e;
+            adjacency[m.v][m.slotV].edge = e;
+            edges[e] = m;
+        }
+        edges.pop_back();
+    }
+
+    void appendInside(const std::vector<uint32_t>& list, float x0, float y0, float x1, float y1,
+                      std::vector<uint32_t>& out) const {
+        for (uint32_t id : list) {
+            const Node& n = nodes[id];
+            if (n.x >= x0 && n.x <= x1 && n.y >= y0 && n.y <= y1) out.push_back(id);
+        }
+    }
+
+    float radius, cellSize;
+    std::vector<Node> nodes;
+    std::vector<std::vector<Neighbor>> adjacency;
+    std::vector<EditorEdge> edges;
+    std::vector<uint32_t> freeIds;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+    uint32_t live = 0;
+};
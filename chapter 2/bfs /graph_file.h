@@ -0,0 +1,301 @@
+// graph_file.h
+// Binary CSR graph files that are memory-mapped and used in place, so a big
+// graph is ready as soon as it is mapped instead of after minutes of text
+// parsing.
+//
+// Layout (little-endian; every section starts on a 64-byte boundary):
+//
+//   GraphFileHeader   64 bytes, with each section's byte position
+//   offsets           n + 1 x uint64 (uint32 with GRAPH_OFFSETS_32)
+//   targets           arcs x uint32
+//   weights           arcs x uint32, with GRAPH_HAS_WEIGHTS
+//   coords            n x (float x, float y), with GRAPH_HAS_COORDS
+//
+// Readers take the positions from the header rather than recomputing the
+// layout, so later versions can add sections without breaking them.
+//
+// MappedGraph::view() returns a CsrView with the same accessors as
+// BasicCsrGraph (n, offsets, begin/end, degree, arcs, weight), so templated
+// code such as CsrBfs runs on the mapping directly; nothing is parsed or
+// copied and pages are read as the traversal touches them. toCsr() copies
+// into a CsrGraph for code that needs one.
+//
+// The access pattern picks the madvise() hints:
+//
+//   GRAPH_ACCESS_BFS      offsets WILLNEED (every expanded vertex reads them
+//                         and they are 8 bytes per vertex), targets and
+//                         weights RANDOM: a BFS reads each adjacency list
+//                         once, in frontier order, so readahead around a
+//                         fault mostly fetches lists that are not due yet
+//   GRAPH_ACCESS_SCAN     SEQUENTIAL over the whole file (conversion, checks,
+//                         bottom-up sweeps over all vertices)
+//   GRAPH_ACCESS_PRELOAD  WILLNEED over the whole file, and MAP_POPULATE
+//                         where available: for repeated traversals of a
+//                         graph that fits in memory
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+
+#include "csr_graph.h"
+#include "mapped_file.h"
+
+struct GraphFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t n;
+    uint32_t flags;
+    uint64_t arcs;
+    uint64_t offsetsAt, targetsAt, weightsAt, coordsAt; // byte positions, 0 when absent
+    uint64_t fileBytes;
+};
+
+static_assert(sizeof(GraphFileHeader) == 64, "graph file header is one cache line");
+
+const char GRAPH_FILE_MAGIC[4] = {'C', 'S', 'R', 'G'};
+const uint32_t GRAPH_FILE_VERSION = 1;
+const uint32_t GRAPH_OFFSETS_32 = 1;
+const uint32_t GRAPH_HAS_WEIGHTS = 2;
+const uint32_t GRAPH_HAS_COORDS = 4;
+const uint64_t GRAPH_SECTION_ALIGN = 64;
+
+enum GraphAccess { GRAPH_ACCESS_BFS, GRAPH_ACCESS_SCAN, GRAPH_ACCESS_PRELOAD };
+
+// A CSR graph over memory owned by someone else (a mapping)
+template <typename Offset>
+struct CsrView {
+    using OffsetType = Offset;
+
+    uint32_t n = 0;
+    uint64_t arcCount = 0;
+    const Offset* offsets = nullptr;   // n + 1 entries
+    const uint32_t* targets = nullptr;
+    const uint32_t* weights = nullptr; // nullptr when unweighted
+    const float* coords = nullptr;     // x, y per vertex; nullptr when absent
+
+    uint64_t arcs() const { return arcCount; }
+    uint64_t degree(uint32_t v) const { return offsets[v + 1] - offsets[v]; }
+    const uint32_t* begin(uint32_t v) const { return targets + offsets[v]; }
+    const uint32_t* end(uint32_t v) const { return targets + offsets[v + 1]; }
+    bool weighted() const { return weights != nullptr; }
+    uint32_t weight(uint64_t i) const { return weights ? weights[i] : 1; }
+};
+
+inline uint64_t alignSection(uint64_t at) {
+    return (at + GRAPH_SECTION_ALIGN - 1) / GRAPH_SECTION_ALIGN * GRAPH_SECTION_ALIGN;
+}
+
+// Writes g (and coords, 2 floats per vertex, if given) in the layout above
+template <typename Offset>
+bool writeGraphFile(const std::string& path, const BasicCsrGraph<Offset>& g,
+                    const std::vector<float>* coords = nullptr) {
+    if (coords && coords->size() != 2 * (size_t)g.n) {
+        std::cerr << "need 2 coordinates per vertex, got " << coords->size() << std::endl;
+        return false;
+    }
+    GraphFileHeader h{};
+    std::memcpy(h.magic, GRAPH_FILE_MAGIC, 4);
+    h.version = GRAPH_FILE_VERSION;
+    h.n = g.n;
+    h.arcs = g.arcs();
+    h.flags = (sizeof(Offset) == 4 ? GRAPH_OFFSETS_32 : 0) | (g.weighted() ? GRAPH_HAS_WEIGHTS : 0)
+            | (coords ? GRAPH_HAS_COORDS : 0);
+    h.offsetsAt = alignSection(sizeof(h));
+    h.targetsAt = alignSection(h.offsetsAt + g.offsets.size() * sizeof(Offset));
+    uint64_t at = h.targetsAt + g.targets.size() * sizeof(uint32_t);
+    if (g.weighted()) {
+        h.weightsAt = alignSection(at);
+        at = h.weightsAt + g.weights.size() * sizeof(uint32_t);
+    }
+    if (coords) {
+        h.coordsAt = alignSection(at);
+        at = h.coordsAt + coords->size() * sizeof(float);
+    }
+    h.fileBytes = at;
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    uint64_t written = 0;
+    auto section = [&](uint64_t position, const void* data, uint64_t bytes) {
+        static const char zeros[GRAPH_SECTION_ALIGN] = {};
+        out.write(zeros, position - written);
+        out.write((const char*)data, bytes);
+        written = position + bytes;
+    };
+    section(0, &h, sizeof(h));
+    section(h.offsetsAt, g.offsets.data(), g.offsets.size() * sizeof(Offset));
+    section(h.targetsAt, g.targets.data(), g.targets.size() * sizeof(uint32_t));
+    if (h.weightsAt) section(h.weightsAt, g.weights.data(), g.weights.size() * sizeof(uint32_t));
+    if (h.coordsAt) section(h.coordsAt, coords->data(), coords->size() * sizeof(float));
+    if (!out) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+class MappedGraph {
+public:
+    // Maps the file read-only and checks the header and section bounds
+    // (O(1): the arrays themselves are not read; see check())
+    bool open(const std::string& path, GraphAccess access = GRAPH_ACCESS_BFS) {
+        close();
+        if (!file.open(path, access == GRAPH_ACCESS_PRELOAD)) return false;
+        data = file.data();
+        size = file.size();
+        if (size < sizeof(GraphFileHeader)) {
+            std::cerr << path << ": too small for a graph file" << std::endl;
+            close();
+            return false;
+        }
+        if (!validHeader(path)) {
+            close();
+            return false;
+        }
+        advise(access);
+        return true;
+    }
+
+    void close() {
+        file.close();
+        data = nullptr;
+        size = 0;
+    }
+
+    bool isOpen() const { return data != nullptr; }
+    const GraphFileHeader& header() const { return *(const GraphFileHeader*)data; }
+    bool compactOffsets() const { return header().flags & GRAPH_OFFSETS_32; }
+    uint64_t mappedBytes() const { return size; }
+
+    // A view with the file's offset width; false (and no view) otherwise
+    template <typename Offset>
+    bool view(CsrView<Offset>& out) const {
+        if ((sizeof(Offset) == 4) != compactOffsets()) return false;
+        const GraphFileHeader& h = header();
+        out.n = h.n;
+        out.arcCount = h.arcs;
+        out.offsets = (const Offset*)(data + h.offsetsAt);
+        out.targets = (const uint32_t*)(data + h.targetsAt);
+        out.weights = h.weightsAt ? (const uint32_t*)(data + h.weightsAt) : nullptr;
+        out.coords = h.coordsAt ? (const float*)(data + h.coordsAt) : nullptr;
+        return true;
+    }
+
+    // Copies the graph out with 64-bit offsets
+    CsrGraph toCsr() const {
+        CsrGraph g;
+        if (compactOffsets()) {
+            CsrView<uint32_t> v;
+            view(v);
+            copyOut(v, g);
+        } else {
+            CsrView<uint64_t> v;
+            view(v);
+            copyOut(v, g);
+        }
+        return g;
+    }
+
+    // Full O(n + arcs) scan: offsets non-decreasing, every target below n
+    bool check() const {
+        if (compactOffsets()) {
+            CsrView<uint32_t> v;
+            view(v);
+            return checkView(v);
+        }
+        CsrView<uint64_t> v;
+        view(v);
+        return checkView(v);
+    }
+
+private:
+    bool validHeader(const std::string& path) const {
+        const GraphFileHeader& h = header();
+        if (std::memcmp(h.magic, GRAPH_FILE_MAGIC, 4) != 0 || h.version != GRAPH_FILE_VERSION) {
+            std::cerr << path << ": not a version " << GRAPH_FILE_VERSION << " graph file" << std::endl;
+            return false;
+        }
+        if (h.n == NO_VERTEX || h.fileBytes > size) {
+            std::cerr << path << ": truncated" << std::endl;
+            return false;
+        }
+        size_t offsetBytes = (h.flags & GRAPH_OFFSETS_32) ? 4 : 8;
+        bool weights = h.flags & GRAPH_HAS_WEIGHTS, coords = h.flags & GRAPH_HAS_COORDS;
+        bool fits = inside(h.offsetsAt, ((uint64_t)h.n + 1) * offsetBytes) && inside(h.targetsAt, h.arcs * 4)
+                 && (weights ? inside(h.weightsAt, h.arcs * 4) : h.weightsAt == 0)
+                 && (coords ? inside(h.coordsAt, (uint64_t)h.n * 2 * sizeof(float)) : h.coordsAt == 0);
+        if (!fits) {
+            std::cerr << path << ": sections outside the file" << std::endl;
+            return false;
+        }
+        uint64_t first, last;
+        if (offsetBytes == 4) {
+            first = ((const uint32_t*)(data + h.offsetsAt))[0];
+            last = ((const uint32_t*)(data + h.offsetsAt))[h.n];
+        } else {
+            first = ((const uint64_t*)(data + h.offsetsAt))[0];
+            last = ((const uint64_t*)(data + h.offsetsAt))[h.n];
+        }
+        if (first != 0 || last != h.arcs) {
+            std::cerr << path << ": offsets do not cover the " << h.arcs << " arcs" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool inside(uint64_t at, uint64_t bytes) const {
+        return at >= sizeof(GraphFileHeader) && at % GRAPH_SECTION_ALIGN == 0 && at <= size && bytes <= size - at;
+    }
+
+    void advise(GraphAccess access) const {
+        const GraphFileHeader& h = header();
+        if (access == GRAPH_ACCESS_SCAN) {
+            file.advise(0, size, MADV_SEQUENTIAL);
+        } else if (access == GRAPH_ACCESS_PRELOAD) {
+            file.advise(0, size, MADV_WILLNEED);
+        } else {
+            uint64_t offsetBytes = ((uint64_t)h.n + 1) * (compactOffsets() ? 4 : 8);
+            file.advise(0, h.offsetsAt + offsetBytes, MADV_WILLNEED);
+            // Everything after the offsets, leaving alone a page they share with the targets
+            file.advise(h.targetsAt, size, MADV_RANDOM, true);
+        }
+    }
+
+    template <typename Offset>
+    static void copyOut(const CsrView<Offset>& v, CsrGraph& g) {
+        g.n = v.n;
+        g.offsets.assign(v.offsets, v.offsets + v.n + 1);
+        g.targets.assign(v.targets, v.targets + v.arcCount);
+        if (v.weights) g.weights.assign(v.weights, v.weights + v.arcCount);
+    }
+
+    template <typename Offset>
+    static bool checkView(const CsrView<Offset>& v) {
+        for (uint32_t u = 0; u < v.n; u++) {
+            if (v.offsets[u] > v.offsets[u + 1]) {
+                std::cerr << "offsets decrease at vertex " << u << std::endl;
+                return false;
+            }
+        }
+        for (uint64_t i = 0; i < v.arcCount; i++) {
+            if (v.targets[i] >= v.n) {
+                std::cerr << "arc " << i << " points to " << v.targets[i] << ", not below " << v.n << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    MappedFile file;
+    const char* data = nullptr;
+    uint64_t size = 0;
+};
@@ -0,0 +1,179 @@
+// graph_gen.cpp
+// Generates the synthetic trees and graphs of graph_generators.h at scale,
+// straight into a CSR graph or a binary edge file.
+//
+//   g++ -O2 -std=c++17 graph_gen.cpp -o graph_gen -lpthread
+//   ./graph_gen --gen recursive|prufer|path|star|caterpillar|grid|road|rmat|powerlaw
+//               [--nodes N] [--degree D] [--exponent X] [--spine N] [--seed N]
+//               [--threads N] [--out file.edges] [--check]
+//
+// Without --out the source is built into a CSR graph (generated twice, the
+// edge list is never stored) and its size, degrees and build time are
+// printed. --out streams it to a binary edge file instead (header, then
+// uint32 pairs; readEdgeFile() loads it). Grids and road graphs use the
+// largest square of at most --nodes vertices, rmat the next power of two.
+// --degree is the average degree of rmat and powerlaw graphs (default 16),
+// --exponent the power-law exponent (default 2.5), --spine the caterpillar's
+// spine length (default nodes / 10).
+//
+// --check compares the result with the collected edge list on small inputs
+// and, for trees, checks that there are n - 1 edges reaching every vertex.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "csr_graph.h"
+#include "graph_generators.h"
+#include "thread_pool.h"
+#include "tree_diameter.h"
+
+struct Options {
+    std::string gen = "recursive";
+    uint32_t nodes = 1000000;
+    double degree = 16.0;
+    double exponent = 2.5;
+    uint32_t spine = 0;
+    uint64_t seed = 1;
+    int threads = 0;
+    std::string out;
+    bool check = false;
+};
+
+const uint32_t CHECK_MAX_NODES = 1 << 20;
+
+static double secondsSince(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+static bool isTree(const std::string& gen) {
+    return gen == "recursive" || gen == "prufer" || gen == "path" || gen == "star" || gen == "caterpillar";
+}
+
+static EdgeSource makeSource(const Options& opt, ThreadPool& pool) {
+    uint32_t n = opt.nodes;
+    if (opt.gen == "prufer") return pruferTreeSource(n, opt.seed, pool);
+    if (opt.gen == "path") return pathSource(n);
+    if (opt.gen == "star") return starSource(n);
+    if (opt.gen == "caterpillar") return caterpillarSource(n, opt.spine ? opt.spine : std::max<uint32_t>(1, n / 10), opt.seed);
+    if (opt.gen == "grid" || opt.gen == "road") {
+        uint32_t side = (uint32_t)std::sqrt((double)n);
+        return opt.gen == "grid" ? gridSource(side, side) : roadSource(side, side, 0.1, 0.02, opt.seed);
+    }
+    if (opt.gen == "rmat") {
+        int scale = 1;
+        while (scale < 31 && (uint32_t(1) << scale) < n) scale++;
+        return rmatSource(scale, std::max(1, (int)std::lround(opt.degree / 2)), opt.seed);
+    }
+    if (opt.gen == "powerlaw") return powerLawSource(n, opt.degree, opt.exponent, opt.seed);
+    return randomTreeSource(n, opt.seed);
+}
+
+static bool sameGraph(const CsrGraph& a, const CsrGraph& b) {
+    return a.n == b.n && a.offsets == b.offsets && a.targets == b.targets;
+}
+
+// n - 1 edges that reach every vertex from vertex 0
+static bool checkTree(const CsrGraph& g) {
+    if (g.n == 0) return true;
+    if (g.arcs() / 2 != (uint64_t)g.n - 1) {
+        std::cerr << g.arcs() / 2 << " edges for " << g.n << " vertices" << std::endl;
+        return false;
+    }
+    TreeBfs bfs(g);
+    uint32_t levels;
+    bfs.run(0, levels);
+    if (bfs.reachedCount() != g.n) {
+        std::cerr << "vertex 0 reaches " << bfs.reachedCount() << " of " << g.n << " vertices" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool parseArgs(int argc, char** argv, Options& o) {
+    for (int i = 1; i < argc; i++) {
+        bool more = i + 1 < argc;
+        if (std::strcmp(argv[i], "--gen") == 0 && more) o.gen = argv[++i];
+        else if (std::strcmp(argv[i], "--nodes") == 0 && more) o.nodes = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--degree") == 0 && more) o.degree = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--exponent") == 0 && more) o.exponent = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--spine") == 0 && more) o.spine = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--seed") == 0 && more) o.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--threads") == 0 && more) o.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--out") == 0 && more) o.out = argv[++i];
+        else if (std::strcmp(argv[i], "--check") == 0) o.check = true;
+        else return false;
+    }
+    bool knownGen = isTree(o.gen) || o.gen == "grid" || o.gen == "road" || o.gen == "rmat" || o.gen == "powerlaw";
+    return knownGen && o.nodes >= 1 && o.nodes < NO_VERTEX && o.degree > 0 && o.exponent > 2.0;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::cerr << "usage: " << argv[0] << " --gen recursive|prufer|path|star|caterpillar|grid|road|rmat|powerlaw"
+                  << " [--nodes N] [--degree D] [--exponent X] [--spine N] [--seed N] [--threads N]"
+                  << " [--out file.edges] [--check]" << std::endl;
+        return 2;
+    }
+    ThreadPool pool(opt.threads);
+
+    auto t = std::chrono::steady_clock::now();
+    EdgeSource src = makeSource(opt, pool);
+    double setupTime = secondsSince(t);
+    std::printf("generator: %s\nvertices: %u\nchunks: %zu\nsetup_seconds: %.6f\n", opt.gen.c_str(), src.n, src.chunks,
+                setupTime);
+    bool small = src.n <= CHECK_MAX_NODES;
+    if (opt.check && !small) std::cerr << "--check skipped above " << CHECK_MAX_NODES << " vertices" << std::endl;
+
+    if (!opt.out.empty()) {
+        t = std::chrono::steady_clock::now();
+        uint64_t written = 0;
+        if (!writeEdgeFile(opt.out, src, pool, &written)) return 1;
+        double writeTime = secondsSince(t);
+        std::printf("edges: %llu\nwrite_seconds: %.6f\nfile_bytes: %llu\n", (unsigned long long)written, writeTime,
+                    (unsigned long long)(sizeof(EdgeFileHeader) + written * sizeof(Edge)));
+        if (opt.check && small) {
+            std::vector<Edge> edges;
+            uint32_t n;
+            if (!readEdgeFile(opt.out, edges, n)) return 1;
+            std::vector<Edge> expected = collectEdges(src, pool);
+            bool same = n == src.n && edges.size() == expected.size()
+                     && std::equal(edges.begin(), edges.end(), expected.begin(),
+                                   [](const Edge& a, const Edge& b) { return a.u == b.u && a.v == b.v; });
+            if (!same) {
+                std::cerr << opt.out << " differs from the generated edge list" << std::endl;
+                return 1;
+            }
+            std::printf("check: passed\n");
+        }
+        return 0;
+    }
+
+    t = std::chrono::steady_clock::now();
+    CsrGraph g = buildCsr(src, pool);
+    double buildTime = secondsSince(t);
+    uint64_t maxDegree = 0, isolated = 0;
+    for (uint32_t v = 0; v < g.n; v++) {
+        maxDegree = std::max(maxDegree, g.degree(v));
+        isolated += g.degree(v) == 0;
+    }
+    std::printf("edges: %llu\ncsr_seconds: %.6f\ngraph_bytes: %zu\nmax_degree: %llu\nisolated_vertices: %llu\n",
+                (unsigned long long)(g.arcs() / 2), buildTime, g.bytes(), (unsigned long long)maxDegree,
+                (unsigned long long)isolated);
+    if (opt.check) {
+        if (isTree(opt.gen) && !checkTree(g)) return 1;
+        if (small && !sameGraph(g, buildCsr(src.n, collectEdges(src, pool), pool))) {
+            std::cerr << "streamed CSR differs from the one built from the edge list" << std::endl;
+            return 1;
+        }
+        std::printf("check: passed\n");
+    }
+    return 0;
+}
@@ -0,0 +1,451 @@
+// graph_generators.h
+// Synthetic graphs and trees for the graph benchmarks.
+//
+// Every generator is an EdgeSource: the edge list split into fixed chunks,
+// where each chunk seeds its own random stream from (seed, chunk index). The
+// output depends only on the seed, never on the number of threads, and any
+// chunk can be produced again on demand, so a source can go straight into a
+// CSR graph (buildCsr generates it twice and never stores the edge list) or
+// be streamed to a binary edge file chunk by chunk. The *Edges() functions
+// collect a source into a vector.
+//
+//   trees: random recursive, uniform labeled (Pruefer), path, star, caterpillar
+//   graphs: R-MAT, grid, road-like lattice, power-law (Chung-Lu)
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "csr_graph.h"
+#include "thread_pool.h"
+
+const size_t GENERATOR_CHUNK = 1 << 14;
+
+struct SplitMix64 {
+    uint64_t state;
+
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    double nextDouble() { return (next() >> 11) * (1.0 / 9007199254740992.0); } // [0, 1)
+    uint64_t below(uint64_t bound) { return next() % bound; }
+};
+
+inline SplitMix64 chunkRandom(uint64_t seed, uint64_t chunk) {
+    SplitMix64 mix(seed ^ (chunk * 0xd1b54a32d192ed03ULL));
+    return SplitMix64(mix.next());
+}
+
+// Random relabeling so vertex ids carry no locality from the generator
+inline std::vector<uint32_t> randomPermutation(uint32_t n, uint64_t seed) {
+    std::vector<uint32_t> perm(n);
+    for (uint32_t i = 0; i < n; i++) perm[i] = i;
+    SplitMix64 rng(seed);
+    for (uint32_t i = n; i > 1; i--) std::swap(perm[i - 1], perm[rng.below(i)]);
+    return perm;
+}
+
+// --- Edge sources ---
+
+struct EdgeSource {
+    uint32_t n = 0;
+    size_t chunks = 0;
+    // Appends the edges of one chunk to out; safe to call from several threads
+    std::function<void(size_t chunk, std::vector<Edge>& out)> generate;
+};
+
+inline size_t chunkCount(uint64_t items) { return (size_t)((items + GENERATOR_CHUNK - 1) / GENERATOR_CHUNK); }
+
+// Calls fn(first, last) for every GENERATOR_CHUNK-sized range of [0, items) in chunk
+template <typename Fn>
+void forChunkRange(uint64_t items, size_t chunk, Fn fn) {
+    fn((uint64_t)chunk * GENERATOR_CHUNK, std::min<uint64_t>(items, (uint64_t)(chunk + 1) * GENERATOR_CHUNK));
+}
+
+// Edge list of a source, in chunk order: sizes first, then every chunk
+// written straight into its place
+inline std::vector<Edge> collectEdges(const EdgeSource& src, ThreadPool& pool) {
+    std::vector<std::vector<Edge>> buffers(pool.size());
+    std::vector<uint64_t> at(src.chunks + 1, 0);
+    pool.parallelFor(src.chunks, 1, [&](size_t b, size_t e, int tid) {
+        for (size_t c = b; c < e; c++) {
+            buffers[tid].clear();
+            src.generate(c, buffers[tid]);
+            at[c + 1] = buffers[tid].size();
+        }
+    });
+    for (size_t c = 0; c < src.chunks; c++) at[c + 1] += at[c];
+    std::vector<Edge> edges(at[src.chunks]);
+    pool.parallelFor(src.chunks, 1, [&](size_t b, size_t e, int tid) {
+        for (size_t c = b; c < e; c++) {
+            buffers[tid].clear();
+            src.generate(c, buffers[tid]);
+            std::copy(buffers[tid].begin(), buffers[tid].end(), edges.begin() + at[c]);
+        }
+    });
+    return edges;
+}
+
+// CSR graph of a source without materializing its edge list
+inline CsrGraph buildCsr(const EdgeSource& src, ThreadPool& pool) {
+    std::vector<std::vector<Edge>> buffers(pool.size());
+    return buildCsrChunks(src.n, src.chunks, [&](size_t chunk, int tid, auto&& fn) {
+        auto& buf = buffers[tid];
+        buf.clear();
+        src.generate(chunk, buf);
+        for (const Edge& e : buf) fn(e);
+    }, pool);
+}
+
+// --- Kronecker / R-MAT ---
+
+// Graph500 parameters: 2^scale vertices, edgeFactor * 2^scale edges. Each
+// edge descends `scale` levels of the adjacency matrix, picking a quadrant
+// with probabilities a, b, c and 1 - a - b - c. Vertices are then permuted.
+inline EdgeSource rmatSource(int scale, int edgeFactor, uint64_t seed, double a = 0.57, double b = 0.19,
+                             double c = 0.19) {
+    EdgeSource src;
+    src.n = uint32_t(1) << scale;
+    uint64_t m = (uint64_t)edgeFactor << scale;
+    src.chunks = chunkCount(m);
+    auto perm = std::make_shared<std::vector<uint32_t>>(randomPermutation(src.n, seed ^ 0x5eedULL));
+    src.generate = [=](size_t chunk, std::vector<Edge>& out) {
+        SplitMix64 rng = chunkRandom(seed, chunk);
+        forChunkRange(m, chunk, [&](uint64_t first, uint64_t last) {
+            for (uint64_t i = first; i < last; i++) {
+                uint32_t u = 0, v = 0;
+                for (int bit = 0; bit < scale; bit++) {
+                    double r = rng.nextDouble();
+                    bool down = r >= a + b;                    // quadrants c, d
+                    bool right = down ? r >= a + b + c : r >= a; // quadrants b, d
+                    u = (u << 1) | (down ? 1 : 0);
+                    v = (v << 1) | (right ? 1 : 0);
+                }
+                out.push_back({(*perm)[u], (*perm)[v]});
+            }
+        });
+    };
+    return src;
+}
+
+inline std::vector<Edge> rmatEdges(int scale, int edgeFactor, uint64_t seed, ThreadPool& pool,
+                                   double a = 0.57, double b = 0.19, double c = 0.19) {
+    return collectEdges(rmatSource(scale, edgeFactor, seed, a, b, c), pool);
+}
+
+// --- Power law (Chung-Lu) ---
+
+// n vertices, about n * avgDegree / 2 edges, degrees following a power law
+// with the given exponent (2 < exponent; 2.1 .. 3 is typical of social and
+// web graphs). Both ends of every edge are drawn with probability
+// proportional to the weight (rank + 1)^(-1 / (exponent - 1)), by inverting
+// the continuous approximation of the weights' CDF, so no per-vertex table
+// is needed. Vertices are then permuted.
+inline EdgeSource powerLawSource(uint32_t n, double avgDegree, double exponent, uint64_t seed) {
+    EdgeSource src;
+    src.n = n;
+    uint64_t m = n > 1 ? (uint64_t)(n * avgDegree / 2) : 0;
+    src.chunks = chunkCount(m);
+    double alpha = 1.0 / (exponent - 1.0), power = 1.0 - alpha;
+    double span = std::pow(n + 1.0, power) - 1.0;
+    auto perm = std::make_shared<std::vector<uint32_t>>(randomPermutation(n, seed ^ 0x5eedULL));
+    auto draw = [=](SplitMix64& rng) {
+        double u = rng.nextDouble();
+        double x = std::fabs(power) < 1e-9 ? std::pow(n + 1.0, u) - 1.0 : std::pow(1.0 + u * span, 1.0 / power) - 1.0;
+        return (*perm)[std::min<uint32_t>(n - 1, (uint32_t)x)];
+    };
+    src.generate = [=](size_t chunk, std::vector<Edge>& out) {
+        SplitMix64 rng = chunkRandom(seed, chunk);
+        forChunkRange(m, chunk, [&](uint64_t first, uint64_t last) {
+            for (uint64_t i = first; i < last; i++) {
+                uint32_t u = draw(rng);
+                out.push_back({u, draw(rng)});
+            }
+        });
+    };
+    return src;
+}
+
+// --- Grids and road-like graphs ---
+
+// width x height 4-connected lattice, vertex y * width + x; one chunk per row
+inline EdgeSource gridSource(uint32_t width, uint32_t height) {
+    EdgeSource src;
+    src.n = width * height;
+    src.chunks = height;
+    src.generate = [=](size_t y, std::vector<Edge>& out) {
+        for (uint32_t x = 0; x < width; x++) {
+            uint32_t v = (uint32_t)y * width + x;
+            if (x + 1 < width) out.push_back({v, v + 1});
+            if (y + 1 < height) out.push_back({v, v + width});
+        }
+    };
+    return src;
+}
+
+inline std::vector<Edge> gridEdges(uint32_t width, uint32_t height, ThreadPool& pool) {
+    return collectEdges(gridSource(width, height), pool);
+}
+
+// A lattice with a fraction of the streets removed and occasional diagonal
+// shortcuts: low degree, high diameter and mostly local ids, like road maps.
+inline EdgeSource roadSource(uint32_t width, uint32_t height, double dropRate, double shortcutRate, uint64_t seed) {
+    EdgeSource src;
+    src.n = width * height;
+    src.chunks = height;
+    src.generate = [=](size_t y, std::vector<Edge>& out) {
+        SplitMix64 rng = chunkRandom(seed, y);
+        for (uint32_t x = 0; x < width; x++) {
+            uint32_t v = (uint32_t)y * width + x;
+            if (x + 1 < width && rng.nextDouble() >= dropRate) out.push_back({v, v + 1});
+            if (y + 1 < height && rng.nextDouble() >= dropRate) out.push_back({v, v + width});
+            if (x + 1 < width && y + 1 < height && rng.nextDouble() < shortcutRate) out.push_back({v, v + width + 1});
+        }
+    };
+    return src;
+}
+
+inline std::vector<Edge> roadEdges(uint32_t width, uint32_t height, double dropRate, double shortcutRate,
+                                   uint64_t seed, ThreadPool& pool) {
+    return collectEdges(roadSource(width, height, dropRate, shortcutRate, seed), pool);
+}
+
+// --- Trees ---
+
+// Random recursive tree: vertex i > 0 hangs off a uniform vertex below i
+inline EdgeSource randomTreeSource(uint32_t n, uint64_t seed) {
+    EdgeSource src;
+    src.n = n;
+    uint64_t m = n > 0 ? n - 1 : 0;
+    src.chunks = chunkCount(m);
+    src.generate = [=](size_t chunk, std::vector<Edge>& out) {
+        SplitMix64 rng = chunkRandom(seed, chunk);
+        forChunkRange(m, chunk, [&](uint64_t first, uint64_t last) {
+            for (uint64_t i = first; i < last; i++) {
+                uint32_t v = (uint32_t)i + 1;
+                out.push_back({(uint32_t)rng.below(v), v});
+            }
+        });
+    };
+    return src;
+}
+
+inline std::vector<Edge> randomTreeEdges(uint32_t n, uint64_t seed, ThreadPool& pool) {
+    return collectEdges(randomTreeSource(n, seed), pool);
+}
+
+// Edge i is (i, parent[i]) for a parent array over 0 .. n-2 (n-1 is the root)
+inline EdgeSource parentArraySource(std::shared_ptr<const std::vector<uint32_t>> parent) {
+    EdgeSource src;
+    src.n = (uint32_t)parent->size();
+    uint64_t m = src.n > 0 ? src.n - 1 : 0;
+    src.chunks = chunkCount(m);
+    src.generate = [=](size_t chunk, std::vector<Edge>& out) {
+        forChunkRange(m, chunk, [&](uint64_t first, uint64_t last) {
+            for (uint64_t v = first; v < last; v++) out.push_back({(uint32_t)v, (*parent)[v]});
+        });
+    };
+    return src;
+}
+
+// Uniformly random labeled tree: a random Pruefer sequence (n - 2 values in
+// 0 .. n-1), decoded in O(n). The sequence is drawn in seeded chunks and its
+// counts taken in parallel; the decoding is one sequential pass that draws
+// the chunks again instead of storing the sequence, so the only memory is
+// the degree and parent arrays.
+inline EdgeSource pruferTreeSource(uint32_t n, uint64_t seed, ThreadPool& pool) {
+    auto parent = std::make_shared<std::vector<uint32_t>>(n, NO_VERTEX);
+    if (n >= 2) {
+        uint64_t length = n - 2;
+        size_t chunks = chunkCount(length);
+        auto sequenceChunk = [&](size_t chunk, auto&& fn) {
+            SplitMix64 rng = chunkRandom(seed, chunk);
+            forChunkRange(length, chunk, [&](uint64_t first, uint64_t last) {
+                for (uint64_t i = first; i < last; i++) fn((uint32_t)rng.below(n));
+            });
+        };
+        std::vector<uint32_t> degree(n, 1);
+        pool.parallelFor(chunks, 1, [&](size_t b, size_t e, int) {
+            for (size_t c = b; c < e; c++) {
+                sequenceChunk(c, [&](uint32_t x) { __atomic_fetch_add(&degree[x], 1, __ATOMIC_RELAXED); });
+            }
+        });
+        // The smallest leaf is cut next; ptr only moves forward
+        uint32_t ptr = 0;
+        while (degree[ptr] != 1) ptr++;
+        uint32_t leaf = ptr;
+        auto& p = *parent;
+        for (size_t c = 0; c < chunks; c++) {
+            sequenceChunk(c, [&](uint32_t x) {
+                p[leaf] = x;
+                if (--degree[x] == 1 && x < ptr) {
+                    leaf = x;
+                } else {
+                    do ptr++; while (degree[ptr] != 1);
+                    leaf = ptr;
+                }
+            });
+        }
+        p[leaf] = n - 1;
+    }
+    // The decoding leaves n-1 as the root
+    return parentArraySource(parent);
+}
+
+// 0 - 1 - 2 - ... - (n-1)
+inline EdgeSource pathSource(uint32_t n) {
+    EdgeSource src;
+    src.n = n;
+    uint64_t m = n > 0 ? n - 1 : 0;
+    src.chunks = chunkCount(m);
+    src.generate = [=](size_t chunk, std::vector<Edge>& out) {
+        forChunkRange(m, chunk, [&](uint64_t first, uint64_t last) {
+            for (uint64_t v = first; v < last; v++) out.push_back({(uint32_t)v, (uint32_t)v + 1});
+        });
+    };
+    return src;
+}
+
+inline std::vector<Edge> pathEdges(uint32_t n, ThreadPool& pool) { return collectEdges(pathSource(n), pool); }
+
+// Vertex 0 joined to every other vertex
+inline EdgeSource starSource(uint32_t n) {
+    EdgeSource src;
+    src.n = n;
+    uint64_t m = n > 0 ? n - 1 : 0;
+    src.chunks = chunkCount(m);
+    src.generate = [=](size_t chunk, std::vector<Edge>& out) {
+        forChunkRange(m, chunk, [&](uint64_t first, uint64_t last) {
+            for (uint64_t i = first; i < last; i++) out.push_back({0, (uint32_t)i + 1});
+        });
+    };
+    return src;
+}
+
+// A path 0 .. spine-1 with every other vertex hung off a random spine vertex
+inline EdgeSource caterpillarSource(uint32_t n, uint32_t spine, uint64_t seed) {
+    EdgeSource src;
+    src.n = n;
+    spine = std::max<uint32_t>(1, std::min(spine, n));
+    uint64_t m = n > 0 ? n - 1 : 0;
+    src.chunks = chunkCount(m);
+    src.generate = [=](size_t chunk, std::vector<Edge>& out) {
+        SplitMix64 rng = chunkRandom(seed, chunk);
+        forChunkRange(m, chunk, [&](uint64_t first, uint64_t last) {
+            for (uint64_t i = first; i < last; i++) {
+                uint32_t v = (uint32_t)i + 1;
+                out.push_back({v < spine ? v - 1 : (uint32_t)rng.below(spine), v});
+            }
+        });
+    };
+    return src;
+}
+
+// --- Binary edge files ---
+
+// Header, then `edges` records of two little-endian uint32 (u, v)
+struct EdgeFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t n;
+    uint32_t reserved;
+    uint64_t edges;
+};
+
+const char EDGE_FILE_MAGIC[4] = {'E', 'D', 'G', 'E'};
+const uint32_t EDGE_FILE_VERSION = 1;
+
+// Streams a source to disk: a batch of chunks is generated in parallel, then
+// written in chunk order, so memory stays at a few chunks per thread
+inline bool writeEdgeFile(const std::string& path, const EdgeSource& src, ThreadPool& pool,
+                          uint64_t* written = nullptr) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    EdgeFileHeader header{};
+    std::memcpy(header.magic, EDGE_FILE_MAGIC, 4);
+    header.version = EDGE_FILE_VERSION;
+    header.n = src.n;
+    out.write((const char*)&header, sizeof(header));
+
+    size_t batch = 4 * (size_t)pool.size();
+    std::vector<std::vector<Edge>> chunks(batch);
+    for (size_t first = 0; first < src.chunks; first += batch) {
+        size_t count = std::min(batch, src.chunks - first);
+        pool.parallelFor(count, 1, [&](size_t b, size_t e, int) {
+            for (size_t i = b; i < e; i++) {
+                chunks[i].clear();
+                src.generate(first + i, chunks[i]);
+            }
+        });
+        for (size_t i = 0; i < count; i++) {
+            out.write((const char*)chunks[i].data(), chunks[i].size() * sizeof(Edge));
+            header.edges += chunks[i].size();
+        }
+    }
+    out.seekp(0);
+    out.write((const char*)&header, sizeof(header));
+    if (written) *written = header.edges;
+    if (!out) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Whether path starts with the edge file magic
+inline bool isEdgeFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[4];
+    return in.read(magic, 4) && std::memcmp(magic, EDGE_FILE_MAGIC, 4) == 0;
+}
+
+// Loads a file written by writeEdgeFile(); the record count has to match the
+// file size and every endpoint has to be below the header's n
+inline bool readEdgeFile(const std::string& path, std::vector<Edge>& edges, uint32_t& n) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    EdgeFileHeader header;
+    uint64_t size = in ? (uint64_t)in.tellg() : 0;
+    if (!in || !in.seekg(0) || !in.read((char*)&header, sizeof(header))) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    if (std::memcmp(header.magic, EDGE_FILE_MAGIC, 4) != 0 || header.version != EDGE_FILE_VERSION) {
+        std::cerr << path << ": not a version " << EDGE_FILE_VERSION << " edge file" << std::endl;
+        return false;
+    }
+    if (header.n == NO_VERTEX || header.edges != (size - sizeof(header)) / sizeof(Edge)
+        || (size - sizeof(header)) % sizeof(Edge) != 0) {
+        std::cerr << path << ": header says " << header.edges << " edges on " << header.n << " vertices, payload is "
+                  << size - sizeof(header) << " bytes" << std::endl;
+        return false;
+    }
+    edges.resize(header.edges);
+    if (!in.read((char*)edges.data(), edges.size() * sizeof(Edge))) {
+        std::cerr << path << ": truncated" << std::endl;
+        return false;
+    }
+    for (uint64_t i = 0; i < edges.size(); i++) {
+        if (edges[i].u >= header.n || edges[i].v >= header.n) {
+            std::cerr << path << ": edge " << i << " (" << edges[i].u << ", " << edges[i].v << ") is out of range for "
+                      << header.n << " vertices" << std::endl;
+            return false;
+        }
+    }
+    n = header.n;
+    return true;
+}
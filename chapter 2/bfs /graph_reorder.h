@@ -0,0 +1,358 @@
+// graph_reorder.h
+// Vertex renumbering for cache locality. A BFS touches the adjacency list
+// and the visited bit of every neighbor; when neighbors have nearby ids
+// those land in cache lines already loaded, when ids are arbitrary (RMAT,
+// shuffled inputs) nearly every one is a miss.
+//
+//   degree  hubs first (stable by id): the most-touched vertices share lines
+//   bfs     BFS order, each component from its highest-degree vertex
+//   rcm     reverse Cuthill-McKee: BFS from a pseudo-peripheral vertex with
+//           each vertex's new neighbors taken by ascending degree, reversed;
+//           keeps neighbors close on meshes and road networks
+//   gorder  a light Gorder: greedily places next the vertex with the most
+//           neighbors and siblings (shared neighbors) among the last
+//           GORDER_WINDOW placed. Siblings are only counted through shared
+//           neighbors of degree GORDER_HUB_DEGREE or less, which keeps the
+//           cost near O(m * GORDER_HUB_DEGREE) instead of O(sum of degree^2).
+//
+// Isolated vertices always go last. A VertexPermutation keeps both
+// directions of the mapping, so results computed on the renumbered graph
+// (permuteCsr()) are mapped back with unpermuteValues() / unpermuteVertices().
+// meanGapBits() is the average number of bits of |u - v| over the arcs, the
+// locality the orders try to improve.
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "csr_graph.h"
+
+enum VertexOrder { ORDER_NONE, ORDER_DEGREE, ORDER_BFS, ORDER_RCM, ORDER_GORDER };
+const int ORDER_COUNT = 5;
+
+const size_t GORDER_WINDOW = 5;
+const uint64_t GORDER_HUB_DEGREE = 32;
+const int PERIPHERAL_ROUNDS = 4; // BFS sweeps when looking for an RCM start
+
+inline const char* orderName(VertexOrder order) {
+    switch (order) {
+        case ORDER_NONE:   return "none";
+        case ORDER_DEGREE: return "degree";
+        case ORDER_BFS:    return "bfs";
+        case ORDER_RCM:    return "rcm";
+        case ORDER_GORDER: return "gorder";
+        default: return "?";
+    }
+}
+
+inline bool parseOrder(const std::string& name, VertexOrder& out) {
+    for (int o = 0; o < ORDER_COUNT; o++) {
+        if (name == orderName((VertexOrder)o)) {
+            out = (VertexOrder)o;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct VertexPermutation {
+    std::vector<uint32_t> order; // order[new id] = old id
+    std::vector<uint32_t> rank;  // rank[old id] = new id
+
+    // From the old ids in their new order
+    static VertexPermutation fromOrder(std::vector<uint32_t> order) {
+        VertexPermutation p;
+        p.rank.resize(order.size());
+        for (uint32_t i = 0; i < (uint32_t)order.size(); i++) p.rank[order[i]] = i;
+        p.order = std::move(order);
+        return p;
+    }
+
+    // From the new id of every old id
+    static VertexPermutation fromRank(std::vector<uint32_t> rank) {
+        VertexPermutation p;
+        p.order.resize(rank.size());
+        for (uint32_t v = 0; v < (uint32_t)rank.size(); v++) p.order[rank[v]] = v;
+        p.rank = std::move(rank);
+        return p;
+    }
+
+    static VertexPermutation identity(uint32_t n) {
+        std::vector<uint32_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        return fromOrder(std::move(order));
+    }
+
+    uint32_t toNew(uint32_t old) const { return old == NO_VERTEX ? NO_VERTEX : rank[old]; }
+    uint32_t toOld(uint32_t v) const { return v == NO_VERTEX ? NO_VERTEX : order[v]; }
+    size_t bytes() const { return (order.size() + rank.size()) * sizeof(uint32_t); }
+};
+
+// byOld[old id] = byNew[new id]: per-vertex values (distances, labels) back in the old numbering
+template <typename T>
+void unpermuteValues(const VertexPermutation& p, const std::vector<T>& byNew, std::vector<T>& byOld) {
+    byOld.resize(byNew.size());
+    for (size_t v = 0; v < byNew.size(); v++) byOld[p.order[v]] = byNew[v];
+}
+
+// The same for values that are themselves vertex ids (parents, component
+// roots); NO_VERTEX stays NO_VERTEX
+inline void unpermuteVertices(const VertexPermutation& p, const std::vector<uint32_t>& byNew,
+                              std::vector<uint32_t>& byOld) {
+    byOld.resize(byNew.size());
+    for (size_t v = 0; v < byNew.size(); v++) byOld[p.order[v]] = p.toOld(byNew[v]);
+}
+
+// Renumbers g: vertex v becomes p.rank[v]. Every list is sorted again by new
+// id (weights move with their arcs).
+template <typename Offset>
+BasicCsrGraph<Offset> permuteCsr(const BasicCsrGraph<Offset>& g, const VertexPermutation& p) {
+    BasicCsrGraph<Offset> out;
+    out.n = g.n;
+    out.offsets.assign(g.n + 1, 0);
+    for (uint32_t v = 0; v < g.n; v++) out.offsets[v + 1] = out.offsets[v] + (Offset)g.degree(p.order[v]);
+    out.targets.resize(g.targets.size());
+    out.weights.resize(g.weights.size());
+    std::vector<std::pair<uint32_t, uint32_t>> arcs;
+    for (uint32_t v = 0; v < g.n; v++) {
+        uint32_t old = p.order[v];
+        uint32_t* first = out.targets.data() + out.offsets[v];
+        if (!g.weighted()) {
+            for (const uint32_t* it = g.begin(old); it != g.end(old); ++it) *first++ = p.rank[*it];
+            std::sort(out.targets.data() + out.offsets[v], first);
+            continue;
+        }
+        arcs.clear();
+        for (Offset i = g.offsets[old]; i < g.offsets[old + 1]; i++) {
+            arcs.push_back({p.rank[g.targets[i]], g.weights[i]});
+        }
+        std::sort(arcs.begin(), arcs.end());
+        for (size_t i = 0; i < arcs.size(); i++) {
+            first[i] = arcs[i].first;
+            out.weights[out.offsets[v] + i] = arcs[i].second;
+        }
+    }
+    return out;
+}
+
+template <typename Graph>
+double meanGapBits(const Graph& g) {
+    uint64_t bits = 0;
+    for (uint32_t u = 0; u < g.n; u++) {
+        for (const uint32_t* it = g.begin(u); it != g.end(u); ++it) {
+            uint32_t gap = *it > u ? *it - u : u - *it;
+            bits += gap ? 32 - __builtin_clz(gap) : 0;
+        }
+    }
+    return g.arcs() ? (double)bits / g.arcs() : 0.0;
+}
+
+namespace reorder_detail {
+
+// Appends src's component to order in BFS order, marking it placed; with
+// byDegree each vertex's new neighbors are appended by ascending degree
+template <typename Graph>
+void bfsFrom(const Graph& g, uint32_t src, bool byDegree, std::vector<unsigned char>& placed,
+             std::vector<uint32_t>& order) {
+    size_t head = order.size();
+    order.push_back(src);
+    placed[src] = 1;
+    while (head < order.size()) {
+        uint32_t u = order[head++];
+        size_t first = order.size();
+        for (const uint32_t* it = g.begin(u); it != g.end(u); ++it) {
+            if (placed[*it]) continue;
+            placed[*it] = 1;
+            order.push_back(*it);
+        }
+        if (byDegree) {
+            std::stable_sort(order.begin() + first, order.end(),
+                             [&](uint32_t a, uint32_t b) { return g.degree(a) < g.degree(b); });
+        }
+    }
+}
+
+// A vertex of high eccentricity in src's component (George and Liu): BFS
+// again from the lowest-degree vertex of the last level while that makes the
+// BFS deeper. stamp marks vertices seen in the current sweep.
+template <typename Graph>
+uint32_t peripheralVertex(const Graph& g, uint32_t src, std::vector<uint32_t>& stamp, uint32_t& sweep,
+                          std::vector<uint32_t>& queue) {
+    uint32_t bestDepth = 0;
+    for (int round = 0; round < PERIPHERAL_ROUNDS; round++) {
+        sweep++;
+        queue.clear();
+        queue.push_back(src);
+        stamp[src] = sweep;
+        size_t head = 0, levelStart = 0, levelEnd = 1;
+        uint32_t depth = 0;
+        while (head < queue.size()) {
+            uint32_t u = queue[head++];
+            for (const uint32_t* it = g.begin(u); it != g.end(u); ++it) {
+                if (stamp[*it] == sweep) continue;
+                stamp[*it] = sweep;
+                queue.push_back(*it);
+            }
+            if (head == levelEnd && head < queue.size()) {
+                depth++;
+                levelStart = levelEnd;
+                levelEnd = queue.size();
+            }
+        }
+        if (round > 0 && depth <= bestDepth) break;
+        bestDepth = depth;
+        src = *std::min_element(queue.begin() + levelStart, queue.end(),
+                                [&](uint32_t a, uint32_t b) { return g.degree(a) < g.degree(b); });
+    }
+    return src;
+}
+
+// Bucket queue of scores that only move by one: O(1) increment, decrement
+// and remove, pop of a highest-score vertex amortized O(1)
+class UnitHeap {
+public:
+    explicit UnitHeap(const std::vector<uint32_t>& members, uint32_t n)
+        : key(n, REMOVED), prev(n, NO_VERTEX), next(n, NO_VERTEX), head(1, NO_VERTEX) {
+        for (size_t i = members.size(); i-- > 0;) insert(members[i], 0);
+    }
+
+    void add(uint32_t v, int delta) {
+        if (key[v] == REMOVED) return;
+        uint32_t k = key[v] + delta;
+        unlink(v);
+        insert(v, k);
+    }
+
+    void remove(uint32_t v) {
+        if (key[v] == REMOVED) return;
+        unlink(v);
+        key[v] = REMOVED;
+    }
+
+    // NO_VERTEX when empty
+    uint32_t pop() {
+        while (top > 0 && head[top] == NO_VERTEX) top--;
+        uint32_t v = head[top];
+        if (v != NO_VERTEX) remove(v);
+        return v;
+    }
+
+private:
+    static const uint32_t REMOVED = UINT32_MAX;
+
+    void insert(uint32_t v, uint32_t k) {
+        if (k >= head.size()) head.resize(k + 1, NO_VERTEX);
+        key[v] = k;
+        prev[v] = NO_VERTEX;
+        next[v] = head[k];
+        if (head[k] != NO_VERTEX) prev[head[k]] = v;
+        head[k] = v;
+        top = std::max(top, k);
+    }
+
+    void unlink(uint32_t v) {
+        if (prev[v] != NO_VERTEX) next[prev[v]] = next[v];
+        else head[key[v]] = next[v];
+        if (next[v] != NO_VERTEX) prev[next[v]] = prev[v];
+    }
+
+    std::vector<uint32_t> key, prev, next;
+    std::vector<uint32_t> head; // first vertex of each score
+    uint32_t top = 0;           // no score above top has vertices
+};
+
+template <typename Graph>
+void appendIsolated(const Graph& g, std::vector<uint32_t>& order) {
+    for (uint32_t v = 0; v < g.n; v++) {
+        if (g.degree(v) == 0) order.push_back(v);
+    }
+}
+
+} // namespace reorder_detail
+
+template <typename Graph>
+std::vector<uint32_t> degreeOrder(const Graph& g) {
+    std::vector<uint32_t> order(g.n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return g.degree(a) > g.degree(b); });
+    return order;
+}
+
+template <typename Graph>
+std::vector<uint32_t> bfsOrder(const Graph& g) {
+    std::vector<uint32_t> order;
+    order.reserve(g.n);
+    std::vector<unsigned char> placed(g.n, 0);
+    for (uint32_t v : degreeOrder(g)) {
+        if (g.degree(v) == 0) break;
+        if (!placed[v]) reorder_detail::bfsFrom(g, v, false, placed, order);
+    }
+    reorder_detail::appendIsolated(g, order);
+    return order;
+}
+
+template <typename Graph>
+std::vector<uint32_t> rcmOrder(const Graph& g) {
+    std::vector<uint32_t> order, queue;
+    order.reserve(g.n);
+    std::vector<unsigned char> placed(g.n, 0);
+    std::vector<uint32_t> stamp(g.n, 0);
+    uint32_t sweep = 0;
+    for (uint32_t v = 0; v < g.n; v++) {
+        if (placed[v] || g.degree(v) == 0) continue;
+        uint32_t start = reorder_detail::peripheralVertex(g, v, stamp, sweep, queue);
+        reorder_detail::bfsFrom(g, start, true, placed, order);
+    }
+    std::reverse(order.begin(), order.end());
+    reorder_detail::appendIsolated(g, order);
+    return order;
+}
+
+template <typename Graph>
+std::vector<uint32_t> gorderOrder(const Graph& g) {
+    std::vector<uint32_t> members, order;
+    for (uint32_t v = 0; v < g.n; v++) {
+        if (g.degree(v) > 0) members.push_back(v);
+    }
+    order.reserve(g.n);
+    if (!members.empty()) {
+        reorder_detail::UnitHeap heap(members, g.n);
+        // v entering (+1) or leaving (-1) the window changes the scores of
+        // its neighbors and of its siblings through non-hub neighbors
+        auto update = [&](uint32_t v, int delta) {
+            for (const uint32_t* it = g.begin(v); it != g.end(v); ++it) {
+                uint32_t u = *it;
+                heap.add(u, delta);
+                if (g.degree(u) > GORDER_HUB_DEGREE) continue;
+                for (const uint32_t* jt = g.begin(u); jt != g.end(u); ++jt) {
+                    if (*jt != v) heap.add(*jt, delta);
+                }
+            }
+        };
+        uint32_t first = *std::max_element(members.begin(), members.end(),
+                                           [&](uint32_t a, uint32_t b) { return g.degree(a) < g.degree(b); });
+        heap.remove(first);
+        order.push_back(first);
+        for (size_t i = 1; i < members.size(); i++) {
+            update(order[i - 1], 1);
+            if (i > GORDER_WINDOW) update(order[i - 1 - GORDER_WINDOW], -1);
+            order.push_back(heap.pop());
+        }
+    }
+    reorder_detail::appendIsolated(g, order);
+    return order;
+}
+
+template <typename Graph>
+VertexPermutation vertexOrder(const Graph& g, VertexOrder order) {
+    switch (order) {
+        case ORDER_DEGREE: return VertexPermutation::fromOrder(degreeOrder(g));
+        case ORDER_BFS:    return VertexPermutation::fromOrder(bfsOrder(g));
+        case ORDER_RCM:    return VertexPermutation::fromOrder(rcmOrder(g));
+        case ORDER_GORDER: return VertexPermutation::fromOrder(gorderOrder(g));
+        default:           return VertexPermutation::identity(g.n);
+    }
+}
@@ -0,0 +1,116 @@
+// latency_histogram.h
+// HDR-style latency histograms: log-linear buckets with 32 sub-buckets per
+// power of two, so any recorded value is known to within ~3% and the whole
+// range of uint64 nanoseconds fits in 1920 counters.
+//
+// A histogram has one writer (the thread running the queries). Counters are
+// relaxed atomics that the writer updates with a load and a store (no locked
+// instruction on the query path), so another thread may read or merge it at
+// any time without a lock, e.g. to dump a snapshot while a batch is still running. Histograms
+// merge by adding counters, so per-thread histograms combine exactly.
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 5;
+    static const int SUB_COUNT = 1 << SUB_BITS;                   // 32
+    static const int BUCKETS = 2 * SUB_COUNT + (63 - SUB_BITS) * SUB_COUNT; // 1920
+
+    LatencyHistogram() { reset(); }
+    LatencyHistogram(const LatencyHistogram& o) { reset(); merge(o); }
+    LatencyHistogram& operator=(const LatencyHistogram& o) {
+        if (this != &o) { reset(); merge(o); }
+        return *this;
+    }
+
+    // Values below 64 get their own bucket; above that, 32 buckets per octave
+    static int bucketOf(uint64_t v) {
+        if (v < 2 * SUB_COUNT) return (int)v;
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - SUB_BITS;
+        return 2 * SUB_COUNT + (shift - 1) * SUB_COUNT + (int)((v >> shift) - SUB_COUNT);
+    }
+
+    // Largest value that falls into bucket i
+    static uint64_t bucketHigh(int i) {
+        if (i < 2 * SUB_COUNT) return (uint64_t)i;
+        int shift = (i - 2 * SUB_COUNT) / SUB_COUNT + 1;
+        uint64_t top = (uint64_t)((i - 2 * SUB_COUNT) % SUB_COUNT + SUB_COUNT);
+        return (top << shift) + ((uint64_t(1) << shift) - 1);
+    }
+
+    // Single writer only: plain relaxed loads and stores, no locked
+    // read-modify-writes; readers still see whole values
+    void record(uint64_t v) {
+        bump(buckets[bucketOf(v)], 1);
+        bump(total, 1);
+        bump(sum, v);
+        if (v > maxValue.load(std::memory_order_relaxed)) maxValue.store(v, std::memory_order_relaxed);
+    }
+
+    // Adds o's counts to this histogram (this one must not be written concurrently)
+    void merge(const LatencyHistogram& o) {
+        for (int i = 0; i < BUCKETS; i++) {
+            uint64_t c = o.buckets[i].load(std::memory_order_relaxed);
+            if (c) buckets[i].fetch_add(c, std::memory_order_relaxed);
+        }
+        total.fetch_add(o.total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        sum.fetch_add(o.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        uint64_t m = o.maxValue.load(std::memory_order_relaxed);
+        if (m > maxValue.load(std::memory_order_relaxed)) maxValue.store(m, std::memory_order_relaxed);
+    }
+
+    void reset() {
+        for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
+        total.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        maxValue.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxValue.load(std::memory_order_relaxed); }
+    double mean() const { return count() ? (double)sum.load(std::memory_order_relaxed) / count() : 0.0; }
+
+    // Smallest bucket bound with at least q (0..1) of the values at or below it
+    uint64_t percentile(double q) const {
+        uint64_t n = count();
+        if (n == 0) return 0;
+        uint64_t rank = (uint64_t)(q * n + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > n) rank = n;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                uint64_t high = bucketHigh(i);
+                return high < max() ? high : max();
+            }
+        }
+        return max();
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& counter, uint64_t by) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> buckets[BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> maxValue;
+};
+
+// One line: count, mean, p50, p99, p99.9, max in microseconds
+inline void writeLatencyLine(std::ostream& out, const std::string& label, const LatencyHistogram& h) {
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-24s n=%-9llu mean=%9.2fus p50=%9.2fus p99=%9.2fus p99.9=%9.2fus max=%9.2fus\n",
+                  label.c_str(), (unsigned long long)h.count(), h.mean() / 1000.0,
+                  h.percentile(0.50) / 1000.0, h.percentile(0.99) / 1000.0,
+                  h.percentile(0.999) / 1000.0, h.max() / 1000.0);
+    out << line;
+}
@@ -0,0 +1,77 @@
+// mapped_file.h
+// A read-only memory mapping of a whole file, shared by the binary graph
+// files (graph_file.h) and the text edge list parser (edge_list_parser.h).
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // populate asks for every page up front (MAP_POPULATE, where available).
+    // An empty file opens fine with size() 0 and no mapping.
+    bool open(const std::string& path, bool populate = false) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Failed to open " << path << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            std::cerr << "Failed to stat " << path << std::endl;
+            ::close(fd);
+            return false;
+        }
+        if (st.st_size == 0) {
+            ::close(fd);
+            return true;
+        }
+        int mapFlags = MAP_SHARED;
+#ifdef MAP_POPULATE
+        if (populate) mapFlags |= MAP_POPULATE;
+#else
+        (void)populate;
+#endif
+        void* base = mmap(nullptr, (size_t)st.st_size, PROT_READ, mapFlags, fd, 0);
+        ::close(fd); // the mapping keeps the file open
+        if (base == MAP_FAILED) {
+            std::cerr << "Failed to map " << path << std::endl;
+            return false;
+        }
+        bytes = (const char*)base;
+        length = (uint64_t)st.st_size;
+        return true;
+    }
+
+    void close() {
+        if (bytes) munmap((void*)bytes, length);
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const char* data() const { return bytes; }
+    uint64_t size() const { return length; }
+
+    // madvise over [at, end); madvise wants a page-aligned start, so at is
+    // rounded down, or up with roundUp to leave a shared first page alone
+    void advise(uint64_t at, uint64_t end, int advice, bool roundUp = false) const {
+        uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+        uint64_t begin = (roundUp ? at + page - 1 : at) / page * page;
+        if (bytes && begin < end) madvise((void*)(bytes + begin), (size_t)(end - begin), advice);
+    }
+
+private:
+    const char* bytes = nullptr;
+    uint64_t length = 0;
+};
@@ -0,0 +1,187 @@
+// move_tables.h
+// Precomputed move tables for the table-driven search engine.
+//
+// For the standard 8x8 board the tables are constexpr arrays, computed by the
+// compiler and stored in the binary, so using them costs nothing at startup.
+// Other board sizes get their tables built on first use: each (size, kind)
+// table is built exactly once under std::call_once, even when several
+// threads ask for it at the same time, and then shared read-only.
+//
+// Step tables list, per square, the squares a knight or king reaches on an
+// empty board (row-major CSR, same order as generateMoves). Ray tables hold,
+// per square and QUEEN_DIRS direction, how many squares lie before the edge.
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "chess_moves.h"
+
+// Same order as KNIGHT_MOVES and the king loop in generateMoves
+constexpr int KNIGHT_STEPS[8][2] = {{2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2}};
+constexpr int KING_STEPS[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
+// QUEEN_DIRS order: the rook uses 0-3, the bishop 4-7
+constexpr int RAY_DIRS[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+// Read-only view of a step table, embedded or built
+struct StepTableView {
+    int size = 0;
+    const uint32_t* offsets = nullptr; // cells + 1
+    const uint32_t* targets = nullptr;
+};
+
+struct RayTableView {
+    int size = 0;
+    const uint32_t* length = nullptr; // cells * 8
+};
+
+// --- Embedded 8x8 tables ---
+
+constexpr int countSteps(const int (&steps)[8][2], int size) {
+    int count = 0;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            for (const auto& s : steps) {
+                int nx = x + s[0], ny = y + s[1];
+                if (nx >= 0 && nx < size && ny >= 0 && ny < size) count++;
+            }
+        }
+    }
+    return count;
+}
+
+template <int Count>
+struct FixedStepTable {
+    uint32_t offsets[BOARD_SIZE * BOARD_SIZE + 1];
+    uint32_t targets[Count];
+};
+
+template <int Count>
+constexpr FixedStepTable<Count> makeFixedStepTable(const int (&steps)[8][2]) {
+    FixedStepTable<Count> t{};
+    uint32_t n = 0;
+    for (int cell = 0; cell < BOARD_SIZE * BOARD_SIZE; cell++) {
+        int x = cell % BOARD_SIZE, y = cell / BOARD_SIZE;
+        t.offsets[cell] = n;
+        for (const auto& s : steps) {
+            int nx = x + s[0], ny = y + s[1];
+            if (nx >= 0 && nx < BOARD_SIZE && ny >= 0 && ny < BOARD_SIZE) t.targets[n++] = (uint32_t)(ny * BOARD_SIZE + nx);
+        }
+    }
+    t.offsets[BOARD_SIZE * BOARD_SIZE] = n;
+    return t;
+}
+
+struct FixedRayTable {
+    uint32_t length[BOARD_SIZE * BOARD_SIZE * 8];
+};
+
+constexpr FixedRayTable makeFixedRayTable() {
+    FixedRayTable t{};
+    for (int cell = 0; cell < BOARD_SIZE * BOARD_SIZE; cell++) {
+        for (int d = 0; d < 8; d++) {
+            int x = cell % BOARD_SIZE + RAY_DIRS[d][0], y = cell / BOARD_SIZE + RAY_DIRS[d][1];
+            uint32_t n = 0;
+            for (; x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE; x += RAY_DIRS[d][0], y += RAY_DIRS[d][1]) n++;
+            t.length[cell * 8 + d] = n;
+        }
+    }
+    return t;
+}
+
+constexpr auto KNIGHT_TABLE_8 = makeFixedStepTable<countSteps(KNIGHT_STEPS, BOARD_SIZE)>(KNIGHT_STEPS);
+constexpr auto KING_TABLE_8 = makeFixedStepTable<countSteps(KING_STEPS, BOARD_SIZE)>(KING_STEPS);
+constexpr FixedRayTable RAY_TABLE_8 = makeFixedRayTable();
+
+static_assert(KNIGHT_TABLE_8.offsets[BOARD_SIZE * BOARD_SIZE] == 336, "knight moves on 8x8");
+static_assert(KING_TABLE_8.offsets[BOARD_SIZE * BOARD_SIZE] == 420, "king moves on 8x8");
+static_assert(RAY_TABLE_8.length[0] == 7 && RAY_TABLE_8.length[7 * 8 + 4] == 0, "rays from the corners");
+
+// --- Tables built on first use ---
+
+class MoveTableCache {
+public:
+    StepTableView step(int size, PieceType piece) {
+        Entry& e = entry(size, piece == KING_P ? KIND_KING : KIND_KNIGHT);
+        std::call_once(e.once, [&] { buildSteps(e, size, piece == KING_P ? KING_STEPS : KNIGHT_STEPS); });
+        return {size, e.offsets.data(), e.targets.data()};
+    }
+
+    RayTableView ray(int size) {
+        Entry& e = entry(size, KIND_RAY);
+        std::call_once(e.once, [&] { buildRays(e, size); });
+        return {size, e.targets.data()};
+    }
+
+private:
+    enum Kind { KIND_KNIGHT, KIND_KING, KIND_RAY };
+
+    struct Entry {
+        std::once_flag once;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> targets; // ray lengths for KIND_RAY
+    };
+
+    // Entries are never removed, so the reference stays valid after unlocking
+    Entry& entry(int size, Kind kind) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& slot = entries[{size, kind}];
+        if (!slot) slot.reset(new Entry());
+        return *slot;
+    }
+
+    static void buildSteps(Entry& e, int size, const int (&steps)[8][2]) {
+        e.offsets.resize((size_t)size * size + 1);
+        e.targets.reserve((size_t)size * size * 8);
+        for (int cell = 0; cell < size * size; cell++) {
+            int x = cell % size, y = cell / size;
+            e.offsets[cell] = (uint32_t)e.targets.size();
+            for (const auto& s : steps) {
+                int nx = x + s[0], ny = y + s[1];
+                if (nx >= 0 && nx < size && ny >= 0 && ny < size) e.targets.push_back((uint32_t)(ny * size + nx));
+            }
+        }
+        e.offsets[(size_t)size * size] = (uint32_t)e.targets.size();
+        e.targets.shrink_to_fit();
+    }
+
+    static void buildRays(Entry& e, int size) {
+        e.targets.resize((size_t)size * size * 8);
+        for (int cell = 0; cell < size * size; cell++) {
+            int x = cell % size, y = cell / size;
+            for (int d = 0; d < 8; d++) {
+                int dx = RAY_DIRS[d][0], dy = RAY_DIRS[d][1];
+                int toX = dx > 0 ? size - 1 - x : dx < 0 ? x : size;
+                int toY = dy > 0 ? size - 1 - y : dy < 0 ? y : size;
+                e.targets[(size_t)cell * 8 + d] = (uint32_t)std::min(toX, toY);
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::map<std::pair<int, int>, std::unique_ptr<Entry>> entries;
+};
+
+inline MoveTableCache& moveTableCache() {
+    static MoveTableCache cache; // thread-safe local static
+    return cache;
+}
+
+// Knight or king table for a board size
+inline StepTableView stepTable(int size, PieceType piece) {
+    if (size == BOARD_SIZE) {
+        const uint32_t* offsets = piece == KING_P ? KING_TABLE_8.offsets : KNIGHT_TABLE_8.offsets;
+        const uint32_t* targets = piece == KING_P ? KING_TABLE_8.targets : KNIGHT_TABLE_8.targets;
+        return {size, offsets, targets};
+    }
+    return moveTableCache().step(size, piece);
+}
+
+inline RayTableView rayTable(int size) {
+    if (size == BOARD_SIZE) return {size, RAY_TABLE_8.length};
+    return moveTableCache().ray(size);
+}
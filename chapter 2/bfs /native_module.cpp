@@ -0,0 +1,239 @@
+// native_module.cpp
+// Python bindings (pybind11) for the C++ engines, so bfs.py and
+// tree_diameter.py can hand the searching to native code and only draw.
+//
+//   c++ -O2 -std=c++17 -shared -fPIC $(python3 -m pybind11 --includes) native_module.cpp -o bfs_native$(python3-config --extension-suffix) -lpthread
+//
+// Arrays are passed as NumPy arrays without copying where the layout
+// allows: uint32 edge arrays of shape (m, 2) and int32 query arrays are read
+// in place (other dtypes are converted once by pybind11), and every array
+// returned is a NumPy view of the C++ vector that produced it, freed when
+// the array is. The GIL is released while the engines run.
+//
+//   search(piece, start, goal, board_size=8, blocked=None, engine="table")
+//       -> (distance, path)        path: int32 (k, 2) of (x, y), start .. goal
+//   search_batch(queries, board_size=8, blocked=None, engine="table", threads=0)
+//       -> distances               queries: int32 (q, 5) rows of piece, sx, sy, gx, gy
+//   tree_diameter(edges, n, start=0)
+//       -> (a, b, length, path, distance_from_a)
+//   tree_eccentricity(edges, n, start=0)
+//       -> (eccentricities, radius, centers)
+//   tree_distances(edges, n, pairs)
+//       -> distances               pairs: uint32 (q, 2)
+//
+// Pieces are numbered as in both visualizers (knight, king, rook, bishop,
+// queen = 0 .. 4). blocked is a (board_size, board_size) array indexed
+// [y, x], nonzero for blocked squares. Unreached vertices and vertices in
+// different components get 0xFFFFFFFF (NO_VERTEX).
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "chess_batch.h"
+#include "chess_search.h"
+#include "csr_graph.h"
+#include "thread_pool.h"
+#include "tree_diameter.h"
+#include "tree_lca.h"
+
+namespace py = pybind11;
+
+using EdgeArray = py::array_t<uint32_t, py::array::c_style | py::array::forcecast>;
+using QueryArray = py::array_t<int32_t, py::array::c_style | py::array::forcecast>;
+using MaskArray = py::array_t<uint8_t, py::array::c_style | py::array::forcecast>;
+
+const size_t EDGE_CHUNK = 1 << 16;
+
+// One pool for the whole module, started on first use
+static ThreadPool& nativePool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// Hands the vector's buffer to NumPy; the capsule deletes it with the array
+template <typename T>
+static py::array_t<T> toArray(std::vector<T>&& values, std::vector<py::ssize_t> shape) {
+    auto* owner = new std::vector<T>(std::move(values));
+    py::capsule free(owner, [](void* p) { delete static_cast<std::vector<T>*>(p); });
+    return py::array_t<T>(shape, owner->data(), free);
+}
+
+template <typename T>
+static py::array_t<T> toArray(std::vector<T>&& values) {
+    py::ssize_t size = (py::ssize_t)values.size();
+    return toArray(std::move(values), {size});
+}
+
+static void requireRows(const py::array& a, py::ssize_t columns, const char* what) {
+    if (a.ndim() != 2 || a.shape(1) != columns) {
+        throw std::invalid_argument(std::string(what) + " must have shape (rows, " + std::to_string(columns) + ")");
+    }
+}
+
+// --- Chess searches ---
+
+static PieceType toPiece(int piece) {
+    if (piece < 0 || piece >= PIECE_COUNT) throw std::invalid_argument("piece must be 0 .. 4");
+    return (PieceType)piece;
+}
+
+static EngineType toEngine(const std::string& name) {
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        if (name == engineName((EngineType)e)) return (EngineType)e;
+    }
+    throw std::invalid_argument("unknown engine " + name + " (reference, array, table, csr or csr-hilbert)");
+}
+
+static Board toBoard(int size, const py::object& blocked) {
+    if (size < 1) throw std::invalid_argument("board_size must be positive");
+    Board board;
+    board.size = size;
+    if (!blocked.is_none()) {
+        MaskArray mask = py::cast<MaskArray>(blocked);
+        if (mask.ndim() != 2 || mask.shape(0) != size || mask.shape(1) != size) {
+            throw std::invalid_argument("blocked must have shape (board_size, board_size)");
+        }
+        board.blocked.assign(mask.data(), mask.data() + board.cells());
+    }
+    return board;
+}
+
+static Point toSquare(const Board& board, std::pair<int, int> xy) {
+    if (!board.inside(xy.first, xy.second)) throw std::invalid_argument("square outside the board");
+    return {xy.first, xy.second};
+}
+
+static py::tuple search(int piece, std::pair<int, int> start, std::pair<int, int> goal, int boardSize,
+                        const py::object& blocked, const std::string& engine) {
+    Board board = toBoard(boardSize, blocked);
+    PieceType p = toPiece(piece);
+    Point s = toSquare(board, start), g = toSquare(board, goal);
+    auto searcher = makeEngine(toEngine(engine));
+    SearchResult result;
+    {
+        py::gil_scoped_release release;
+        result = searcher->search(board, p, s, g);
+    }
+    std::vector<int32_t> path(2 * result.path.size());
+    for (size_t i = 0; i < result.path.size(); i++) {
+        path[2 * i] = result.path[i].x;
+        path[2 * i + 1] = result.path[i].y;
+    }
+    py::ssize_t steps = (py::ssize_t)result.path.size();
+    return py::make_tuple(result.distance, toArray(std::move(path), {steps, 2}));
+}
+
+static py::array_t<int32_t> searchBatch(const QueryArray& queries, int boardSize, const py::object& blocked,
+                                        const std::string& engine, int threads) {
+    requireRows(queries, 5, "queries");
+    Board board = toBoard(boardSize, blocked);
+    size_t count = (size_t)queries.shape(0);
+    const int32_t* q = queries.data();
+    std::vector<BatchQuery> batch(count);
+    for (size_t i = 0; i < count; i++) {
+        const int32_t* row = q + 5 * i;
+        batch[i] = {toPiece(row[0]), toSquare(board, {row[1], row[2]}), toSquare(board, {row[3], row[4]})};
+    }
+    BatchOptions options;
+    options.engine = toEngine(engine);
+    options.threads = threads;
+    std::vector<int32_t> distances(count);
+    {
+        py::gil_scoped_release release;
+        std::vector<BatchResult> results = runBatch(board, batch, options);
+        for (size_t i = 0; i < count; i++) distances[i] = results[i].distance;
+    }
+    return toArray(std::move(distances));
+}
+
+// --- Trees ---
+
+// CSR straight from the NumPy edge array: buildCsrChunks() reads the rows in
+// place, so the edges are never copied into a std::vector<Edge>
+static CsrGraph treeFromEdges(const EdgeArray& edges, uint32_t n) {
+    requireRows(edges, 2, "edges");
+    if (n == 0 || n == NO_VERTEX) throw std::invalid_argument("n must be 1 .. 2^32 - 2");
+    size_t count = (size_t)edges.shape(0);
+    const uint32_t* e = edges.data();
+    for (size_t i = 0; i < 2 * count; i++) {
+        if (e[i] >= n) throw std::invalid_argument("edge endpoint " + std::to_string(e[i]) + " is not below n");
+    }
+    py::gil_scoped_release release;
+    size_t chunks = (count + EDGE_CHUNK - 1) / EDGE_CHUNK;
+    return buildCsrChunks(n, chunks, [&](size_t chunk, int, auto&& fn) {
+        size_t end = std::min(count, (chunk + 1) * EDGE_CHUNK);
+        for (size_t i = chunk * EDGE_CHUNK; i < end; i++) fn(Edge{e[2 * i], e[2 * i + 1]});
+    }, nativePool());
+}
+
+static void checkVertex(uint32_t v, const CsrGraph& g) {
+    if (v >= g.n) throw std::invalid_argument("vertex " + std::to_string(v) + " is not below n");
+}
+
+static py::tuple treeDiameterOf(const EdgeArray& edges, uint32_t n, uint32_t start) {
+    CsrGraph g = treeFromEdges(edges, n);
+    checkVertex(start, g);
+    TreeDiameter d;
+    std::vector<uint32_t> fromA(n, NO_VERTEX);
+    {
+        py::gil_scoped_release release;
+        TreeBfs bfs(g);
+        uint32_t levels;
+        d.a = bfs.run(start, levels);
+        d.b = bfs.run(d.a, d.length, &fromA);
+        bfs.pathToLast(d.path);
+    }
+    return py::make_tuple(d.a, d.b, d.length, toArray(std::move(d.path)), toArray(std::move(fromA)));
+}
+
+static py::tuple treeEccentricityOf(const EdgeArray& edges, uint32_t n, uint32_t start) {
+    CsrGraph g = treeFromEdges(edges, n);
+    checkVertex(start, g);
+    TreeEccentricity r;
+    {
+        py::gil_scoped_release release;
+        r = treeEccentricity(g, start);
+    }
+    return py::make_tuple(toArray(std::move(r.ecc)), r.radius, toArray(std::move(r.center)));
+}
+
+static py::array_t<uint32_t> treeDistances(const EdgeArray& edges, uint32_t n, const EdgeArray& pairs) {
+    requireRows(pairs, 2, "pairs");
+    CsrGraph g = treeFromEdges(edges, n);
+    size_t count = (size_t)pairs.shape(0);
+    const uint32_t* q = pairs.data();
+    for (size_t i = 0; i < 2 * count; i++) checkVertex(q[i], g);
+    std::vector<uint32_t> out(count);
+    {
+        py::gil_scoped_release release;
+        TreeLca lca(g);
+        nativePool().parallelFor(count, 4096, [&](size_t b, size_t e, int) {
+            for (size_t i = b; i < e; i++) out[i] = lca.distance(q[2 * i], q[2 * i + 1]);
+        });
+    }
+    return toArray(std::move(out));
+}
+
+PYBIND11_MODULE(bfs_native, m) {
+    m.doc() = "Native BFS engines for the chess and tree diameter visualizers";
+    m.attr("NO_VERTEX") = NO_VERTEX;
+
+    m.def("search", &search, py::arg("piece"), py::arg("start"), py::arg("goal"), py::arg("board_size") = BOARD_SIZE,
+          py::arg("blocked") = py::none(), py::arg("engine") = "table",
+          "Shortest path of one piece; returns (distance, path), distance -1 if unreachable");
+    m.def("search_batch", &searchBatch, py::arg("queries"), py::arg("board_size") = BOARD_SIZE,
+          py::arg("blocked") = py::none(), py::arg("engine") = "table", py::arg("threads") = 0,
+          "Distances for rows of (piece, sx, sy, gx, gy), spread over worker threads");
+    m.def("tree_diameter", &treeDiameterOf, py::arg("edges"), py::arg("n"), py::arg("start") = 0,
+          "Double sweep from start; returns (a, b, length, path, distance_from_a)");
+    m.def("tree_eccentricity", &treeEccentricityOf, py::arg("edges"), py::arg("n"), py::arg("start") = 0,
+          "Eccentricity of every vertex in start's tree; returns (ecc, radius, centers)");
+    m.def("tree_distances", &treeDistances, py::arg("edges"), py::arg("n"), py::arg("pairs"),
+          "Edge counts between the vertex pairs, through an LCA index");
+}
@@ -0,0 +1,196 @@
+// parallel_bfs.h
+// Level-synchronous multi-threaded BFS over a CsrGraph, producing a parent
+// array (and optionally the depth of every vertex).
+//
+// Levels run top-down (each frontier vertex claims its undiscovered neighbors
+// with a compare-and-swap on parent[]) until the frontier touches a large
+// share of the remaining edges; then they run bottom-up (every undiscovered
+// vertex looks for any neighbor in the frontier bitmap and stops at the first
+// hit), and back to top-down once the frontier is small again. This is the
+// direction-optimizing BFS of Beamer et al., with their alpha/beta thresholds.
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "csr_graph.h"
+#include "thread_pool.h"
+
+struct BfsSummary {
+    uint32_t root = NO_VERTEX;
+    uint64_t reached = 0;        // vertices in the root's component
+    uint64_t edges = 0;          // undirected edges in that component
+    uint32_t levels = 0;         // frontiers expanded, i.e. eccentricity(root) + 1
+    uint32_t bottomUpLevels = 0; // how many of them ran bottom-up
+    uint32_t farthest = NO_VERTEX; // a vertex on the last level
+    double seconds = 0.0;
+};
+
+class ParallelBfs {
+public:
+    static const int ALPHA = 14; // go bottom-up when frontier edges > unexplored edges / ALPHA
+    static const int BETA = 24;  // back to top-down when frontier vertices < n / BETA
+
+    ParallelBfs(const CsrGraph& graph, ThreadPool& pool)
+        : g(graph), pool(pool), queue(graph.n), nextQueue(graph.n),
+          frontBits((graph.n + 63) / 64), nextBits((graph.n + 63) / 64), local(pool.size()) {}
+
+    // false: top-down only
+    void setDirectionOptimizing(bool on) { directionOptimizing = on; }
+
+    // parent[v] is NO_VERTEX for unreached vertices and parent[root] == root
+    BfsSummary run(uint32_t root, std::vector<uint32_t>& parent, std::vector<uint32_t>* depth = nullptr) {
+        auto started = std::chrono::steady_clock::now();
+        BfsSummary s;
+        s.root = root;
+        parent.resize(g.n);
+        if (depth) depth->resize(g.n);
+        pool.parallelFor(g.n, 1 << 16, [&](size_t b, size_t e, int) {
+            std::fill(parent.begin() + b, parent.begin() + e, NO_VERTEX);
+            if (depth) std::fill(depth->begin() + b, depth->begin() + e, NO_VERTEX);
+        });
+
+        parent[root] = root;
+        if (depth) (*depth)[root] = 0;
+        queue[0] = root;
+        size_t frontierSize = 1;
+        uint64_t frontierEdges = g.degree(root);
+        uint64_t unexploredEdges = g.arcs() - frontierEdges;
+        bool bottomUp = false;
+        s.reached = 1;
+        s.edges = frontierEdges;
+
+        while (frontierSize > 0) {
+            s.levels++;
+            s.farthest = bottomUp ? firstInBits() : queue[0];
+            if (directionOptimizing) {
+                if (!bottomUp && frontierEdges > unexploredEdges / ALPHA) {
+                    queueToBits(frontierSize);
+                    bottomUp = true;
+                } else if (bottomUp && frontierSize < g.n / BETA) {
+                    frontierSize = bitsToQueue();
+                    bottomUp = false;
+                }
+            }
+            Level next = bottomUp ? bottomUpStep(parent, depth, s.levels) : topDownStep(frontierSize, parent, depth, s.levels);
+            if (bottomUp) s.bottomUpLevels++;
+            frontierSize = next.vertices;
+            frontierEdges = next.edges;
+            unexploredEdges -= std::min(unexploredEdges, frontierEdges);
+            s.reached += next.vertices;
+            s.edges += next.edges;
+        }
+        s.edges /= 2;
+        s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        return s;
+    }
+
+private:
+    struct Level {
+        uint64_t vertices = 0;
+        uint64_t edges = 0; // sum of the new vertices' degrees
+    };
+
+    static const size_t FLUSH_AT = 4096;
+
+    // Appends a worker's buffered vertices to nextQueue
+    void flush(std::vector<uint32_t>& buf, std::atomic<size_t>& nextSize) {
+        if (buf.empty()) return;
+        size_t at = nextSize.fetch_add(buf.size(), std::memory_order_relaxed);
+        std::copy(buf.begin(), buf.end(), nextQueue.begin() + at);
+        buf.clear();
+    }
+
+    Level topDownStep(size_t frontierSize, std::vector<uint32_t>& parent, std::vector<uint32_t>* depth, uint32_t level) {
+        std::atomic<size_t> nextSize{0};
+        std::atomic<uint64_t> nextEdges{0};
+        pool.parallelFor(frontierSize, 64, [&](size_t b, size_t e, int tid) {
+            auto& buf = local[tid];
+            uint64_t edges = 0;
+            for (size_t i = b; i < e; i++) {
+                uint32_t u = queue[i];
+                for (const uint32_t* it = g.begin(u); it != g.end(u); ++it) {
+                    uint32_t v = *it;
+                    if (__atomic_load_n(&parent[v], __ATOMIC_RELAXED) != NO_VERTEX) continue;
+                    uint32_t expected = NO_VERTEX;
+                    if (!__atomic_compare_exchange_n(&parent[v], &expected, u, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) continue;
+                    if (depth) (*depth)[v] = level;
+                    edges += g.degree(v);
+                    buf.push_back(v);
+                    if (buf.size() >= FLUSH_AT) flush(buf, nextSize);
+                }
+            }
+            flush(buf, nextSize);
+            nextEdges.fetch_add(edges, std::memory_order_relaxed);
+        });
+        queue.swap(nextQueue);
+        return {nextSize.load(), nextEdges.load()};
+    }
+
+    // Work is split on 64-vertex words, so each word of nextBits has one writer
+    Level bottomUpStep(std::vector<uint32_t>& parent, std::vector<uint32_t>* depth, uint32_t level) {
+        std::atomic<uint64_t> nextCount{0}, nextEdges{0};
+        pool.parallelFor(frontBits.size(), 64, [&](size_t b, size_t e, int) {
+            uint64_t count = 0, edges = 0;
+            for (size_t w = b; w < e; w++) {
+                uint64_t word = 0;
+                uint32_t last = (uint32_t)std::min<uint64_t>(g.n, (w + 1) * 64);
+                for (uint32_t v = (uint32_t)(w * 64); v < last; v++) {
+                    if (parent[v] != NO_VERTEX) continue;
+                    for (const uint32_t* it = g.begin(v); it != g.end(v); ++it) {
+                        uint32_t u = *it;
+                        if (!(frontBits[u >> 6] >> (u & 63) & 1)) continue;
+                        parent[v] = u;
+                        if (depth) (*depth)[v] = level;
+                        word |= uint64_t(1) << (v & 63);
+                        count++;
+                        edges += g.degree(v);
+                        break;
+                    }
+                }
+                nextBits[w] = word;
+            }
+            nextCount.fetch_add(count, std::memory_order_relaxed);
+            nextEdges.fetch_add(edges, std::memory_order_relaxed);
+        });
+        frontBits.swap(nextBits);
+        return {nextCount.load(), nextEdges.load()};
+    }
+
+    uint32_t firstInBits() const {
+        for (size_t w = 0; w < frontBits.size(); w++) {
+            if (frontBits[w]) return (uint32_t)(w * 64 + __builtin_ctzll(frontBits[w]));
+        }
+        return NO_VERTEX;
+    }
+
+    void queueToBits(size_t frontierSize) {
+        std::fill(frontBits.begin(), frontBits.end(), 0);
+        for (size_t i = 0; i < frontierSize; i++) frontBits[queue[i] >> 6] |= uint64_t(1) << (queue[i] & 63);
+    }
+
+    size_t bitsToQueue() {
+        std::atomic<size_t> size{0};
+        pool.parallelFor(frontBits.size(), 1024, [&](size_t b, size_t e, int tid) {
+            auto& buf = local[tid];
+            for (size_t w = b; w < e; w++) {
+                for (uint64_t word = frontBits[w]; word; word &= word - 1) {
+                    buf.push_back((uint32_t)(w * 64 + __builtin_ctzll(word)));
+                    if (buf.size() >= FLUSH_AT) flush(buf, size);
+                }
+            }
+            flush(buf, size);
+        });
+        queue.swap(nextQueue);
+        return size.load();
+    }
+
+    const CsrGraph& g;
+    ThreadPool& pool;
+    bool directionOptimizing = true;
+    std::vector<uint32_t> queue, nextQueue;
+    std::vector<uint64_t> frontBits, nextBits;
+    std::vector<std::vector<uint32_t>> local; // per-worker output buffers
+};
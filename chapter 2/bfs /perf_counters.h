@@ -0,0 +1,182 @@
+// perf_counters.h
+// Hardware counters (cycles, instructions, cache misses, branch misses) per
+// search phase and piece, read through Linux perf_event_open.
+//
+// This is an opt-in profiling mode: a PhaseProfiler attached to an engine reads
+// the counter group at every phase boundary, including around each neighbor
+// generation, so it costs a system call per boundary. Time between two reads is
+// charged to the innermost open phase, which makes the phases exclusive
+// ("expand" does not include the neighbor generation nested in it).
+// Where the counters cannot be opened (not Linux, perf_event_paranoid, a VM or
+// container without a PMU) enable() returns false, the reason is kept in
+// error(), and begin()/end() do nothing.
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#include "chess_moves.h"
+
+enum PerfEvent { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_CACHE_MISSES, PERF_BRANCH_MISSES };
+const int PERF_EVENT_COUNT = 4;
+
+inline const char* perfEventName(PerfEvent e) {
+    switch (e) {
+        case PERF_CYCLES:        return "cycles";
+        case PERF_INSTRUCTIONS:  return "instructions";
+        case PERF_CACHE_MISSES:  return "cache_misses";
+        case PERF_BRANCH_MISSES: return "branch_misses";
+        default: return "?";
+    }
+}
+
+enum PerfPhase { PERF_PHASE_EXPAND, PERF_PHASE_NEIGHBORS, PERF_PHASE_RECONSTRUCT };
+const int PERF_PHASE_COUNT = 3;
+
+inline const char* perfPhaseName(PerfPhase p) {
+    switch (p) {
+        case PERF_PHASE_EXPAND:      return "expand";
+        case PERF_PHASE_NEIGHBORS:   return "neighbors";
+        case PERF_PHASE_RECONSTRUCT: return "reconstruct";
+        default: return "?";
+    }
+}
+
+struct PerfTotals {
+    double counts[PERF_EVENT_COUNT] = {0, 0, 0, 0};
+    uint64_t entries = 0; // times the phase was entered
+
+    double ipc() const {
+        return counts[PERF_CYCLES] > 0 ? counts[PERF_INSTRUCTIONS] / counts[PERF_CYCLES] : 0.0;
+    }
+};
+
+// --- One group of counters for the calling thread ---
+
+class PerfCounterGroup {
+public:
+    ~PerfCounterGroup() { close(); }
+
+    bool open() {
+#ifdef __linux__
+        static const uint64_t configs[PERF_EVENT_COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.disabled = i == 0; // the leader starts the whole group
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            int fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0);
+            if (fd < 0) {
+                errorText = std::string("perf_event_open(") + perfEventName((PerfEvent)i) + "): " + std::strerror(errno);
+                close();
+                return false;
+            }
+            fds[i] = fd;
+        }
+        ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        return true;
+#else
+        errorText = "hardware counters need Linux perf_event_open";
+        return false;
+#endif
+    }
+
+    bool isOpen() const { return fds[0] >= 0; }
+    const std::string& error() const { return errorText; }
+
+    // Counts since open(), scaled up if the kernel had to multiplex the group.
+    bool read(double out[PERF_EVENT_COUNT]) {
+#ifdef __linux__
+        if (!isOpen()) return false;
+        uint64_t buf[3 + PERF_EVENT_COUNT]; // nr, time_enabled, time_running, values
+        if (::read(fds[0], buf, sizeof(buf)) != (ssize_t)sizeof(buf)) return false;
+        double scale = buf[2] > 0 ? (double)buf[1] / (double)buf[2] : 0.0;
+        for (int i = 0; i < PERF_EVENT_COUNT; i++) out[i] = buf[3 + i] * scale;
+        return true;
+#else
+        (void)out;
+        return false;
+#endif
+    }
+
+    void close() {
+#ifdef __linux__
+        for (int i = PERF_EVENT_COUNT - 1; i >= 0; --i) {
+            if (fds[i] >= 0) ::close(fds[i]);
+            fds[i] = -1;
+        }
+#endif
+    }
+
+private:
+    int fds[PERF_EVENT_COUNT] = {-1, -1, -1, -1};
+    std::string errorText;
+};
+
+// --- Per phase, per piece attribution ---
+
+class PhaseProfiler {
+public:
+    bool enable() {
+        enabled = counters.open();
+        if (enabled) counters.read(last);
+        stack.reserve(PERF_PHASE_COUNT);
+        return enabled;
+    }
+    bool isEnabled() const { return enabled; }
+    const std::string& error() const { return counters.error(); }
+
+    void setPiece(PieceType p) { piece = p; }
+
+    void begin(PerfPhase phase) {
+        if (!enabled) return;
+        charge();
+        stack.push_back(phase);
+        totals[piece][phase].entries++;
+    }
+
+    void end() {
+        if (!enabled || stack.empty()) return;
+        charge();
+        stack.pop_back();
+    }
+
+    const PerfTotals& total(PieceType p, PerfPhase phase) const { return totals[p][phase]; }
+
+private:
+    // Gives everything counted since the last boundary to the innermost phase
+    void charge() {
+        double now[PERF_EVENT_COUNT];
+        if (!counters.read(now)) return;
+        if (!stack.empty()) {
+            PerfTotals& t = totals[piece][stack.back()];
+            for (int i = 0; i < PERF_EVENT_COUNT; i++) t.counts[i] += now[i] - last[i];
+        }
+        std::memcpy(last, now, sizeof(last));
+    }
+
+    PerfCounterGroup counters;
+    bool enabled = false;
+    PieceType piece = KNIGHT_P;
+    std::vector<PerfPhase> stack;
+    double last[PERF_EVENT_COUNT] = {0, 0, 0, 0};
+    PerfTotals totals[PIECE_COUNT][PERF_PHASE_COUNT];
+};
@@ -0,0 +1,192 @@
+// search_stats.h
+// Counters filled in by every search: what the BFS did and where its time went.
+//
+// Allocations and bytes per phase are taken from alloc_tracker.h; they stay
+// zero unless the program installs its operator new hook.
+//
+// Counting is a handful of increments per popped square and three clock reads
+// per search, so it stays on by default. Build with -DCHESS_SEARCH_STATS=0 to
+// compile it out; only nodesPopped is counted then.
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "alloc_tracker.h"
+
+#ifndef CHESS_SEARCH_STATS
+#define CHESS_SEARCH_STATS 1
+#endif
+
+constexpr bool SEARCH_STATS = CHESS_SEARCH_STATS != 0;
+
+enum SearchPhase { PHASE_SETUP, PHASE_EXPAND, PHASE_RECONSTRUCT };
+const int PHASE_COUNT = 3;
+
+inline const char* phaseName(SearchPhase p) {
+    switch (p) {
+        case PHASE_SETUP:       return "setup";
+        case PHASE_EXPAND:      return "expand";
+        case PHASE_RECONSTRUCT: return "reconstruct";
+        default: return "?";
+    }
+}
+
+struct SearchStats {
+    uint64_t nodesPopped = 0;        // squares taken off the queue
+    uint64_t neighborsGenerated = 0; // moves produced by the move generator
+    uint64_t duplicatesRejected = 0; // moves to squares that were already discovered
+    uint64_t maxFrontier = 0;        // largest queue size
+    uint64_t levels = 0;             // BFS levels expanded
+    uint64_t peakStateBytes = 0;     // visited/parent/queue memory at the peak
+    double phaseSeconds[PHASE_COUNT] = {0.0, 0.0, 0.0};
+    uint64_t phaseAllocs[PHASE_COUNT] = {0, 0, 0};
+    uint64_t phaseAllocBytes[PHASE_COUNT] = {0, 0, 0};
+
+    double totalSeconds() const {
+        double t = 0.0;
+        for (double s : phaseSeconds) t += s;
+        return t;
+    }
+
+    uint64_t totalAllocs() const {
+        uint64_t n = 0;
+        for (uint64_t a : phaseAllocs) n += a;
+        return n;
+    }
+
+    uint64_t totalAllocBytes() const {
+        uint64_t n = 0;
+        for (uint64_t b : phaseAllocBytes) n += b;
+        return n;
+    }
+
+    // Sums the counters and times, keeps the largest frontier/levels/state
+    void merge(const SearchStats& o) {
+        nodesPopped += o.nodesPopped;
+        neighborsGenerated += o.neighborsGenerated;
+        duplicatesRejected += o.duplicatesRejected;
+        if (o.maxFrontier > maxFrontier) maxFrontier = o.maxFrontier;
+        if (o.levels > levels) levels = o.levels;
+        if (o.peakStateBytes > peakStateBytes) peakStateBytes = o.peakStateBytes;
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            phaseSeconds[i] += o.phaseSeconds[i];
+            phaseAllocs[i] += o.phaseAllocs[i];
+            phaseAllocBytes[i] += o.phaseAllocBytes[i];
+        }
+    }
+};
+
+// Charges the time and allocations since the previous lap to a phase.
+class PhaseClock {
+public:
+    PhaseClock() {
+        if (SEARCH_STATS) last = std::chrono::steady_clock::now();
+    }
+    void lap(SearchStats& stats, SearchPhase phase) {
+        if (!SEARCH_STATS) return;
+        auto now = std::chrono::steady_clock::now();
+        stats.phaseSeconds[phase] += std::chrono::duration<double>(now - last).count();
+        stats.phaseAllocs[phase] += allocs.allocs();
+        stats.phaseAllocBytes[phase] += allocs.bytes();
+        last = now;
+        allocs.reset();
+    }
+
+private:
+    std::chrono::steady_clock::time_point last;
+    AllocScope allocs;
+};
+
+// Counts BFS levels from the order in which squares are pushed and popped.
+struct LevelCounter {
+    uint64_t remaining = 0; // squares left in the level being expanded
+    uint64_t next = 1;      // squares pushed for the following level (start counts)
+
+    void popped(SearchStats& stats) {
+        if (!SEARCH_STATS) return;
+        if (remaining == 0) {
+            stats.levels++;
+            remaining = next;
+            next = 0;
+        }
+        remaining--;
+    }
+    void pushed() {
+        if (SEARCH_STATS) next++;
+    }
+};
+
+// --- Prometheus text exposition ---
+
+struct LabeledStats {
+    std::string labels;    // e.g. engine="array",piece="knight"
+    uint64_t searches = 0;
+    SearchStats stats;     // merged over all searches
+};
+
+inline void writePrometheusMetric(std::ostream& out, const char* name, const char* type, const char* help,
+                                  const std::vector<LabeledStats>& series, double (*value)(const LabeledStats&)) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+    for (const auto& s : series) out << name << "{" << s.labels << "} " << value(s) << "\n";
+}
+
+inline void writePrometheus(std::ostream& out, const std::vector<LabeledStats>& series) {
+    out.precision(9);
+    writePrometheusMetric(out, "chess_search_total", "counter", "Searches run.", series,
+                          [](const LabeledStats& s) { return (double)s.searches; });
+    writePrometheusMetric(out, "chess_search_nodes_popped_total", "counter", "Squares taken off the BFS queue.", series,
+                          [](const LabeledStats& s) { return (double)s.stats.nodesPopped; });
+    writePrometheusMetric(out, "chess_search_neighbors_generated_total", "counter", "Moves produced by the move generator.", series,
+                          [](const LabeledStats& s) { return (double)s.stats.neighborsGenerated; });
+    writePrometheusMetric(out, "chess_search_duplicates_rejected_total", "counter", "Moves to squares already discovered.", series,
+                          [](const LabeledStats& s) { return (double)s.stats.duplicatesRejected; });
+    writePrometheusMetric(out, "chess_search_max_frontier", "gauge", "Largest BFS queue seen in one search.", series,
+                          [](const LabeledStats& s) { return (double)s.stats.maxFrontier; });
+    writePrometheusMetric(out, "chess_search_max_levels", "gauge", "Most BFS levels expanded in one search.", series,
+                          [](const LabeledStats& s) { return (double)s.stats.levels; });
+    writePrometheusMetric(out, "chess_search_peak_state_bytes", "gauge", "Largest search state in one search.", series,
+                          [](const LabeledStats& s) { return (double)s.stats.peakStateBytes; });
+
+    out << "# HELP chess_search_phase_seconds_total Wall time spent per search phase.\n";
+    out << "# TYPE chess_search_phase_seconds_total counter\n";
+    for (const auto& s : series) {
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            out << "chess_search_phase_seconds_total{" << s.labels << ",phase=\"" << phaseName((SearchPhase)p)
+                << "\"} " << s.stats.phaseSeconds[p] << "\n";
+        }
+    }
+
+    if (allocTrackingInstalled) {
+        out << "# HELP chess_search_phase_allocations_total Heap allocations made per search phase.\n";
+        out << "# TYPE chess_search_phase_allocations_total counter\n";
+        for (const auto& s : series) {
+            for (int p = 0; p < PHASE_COUNT; p++) {
+                out << "chess_search_phase_allocations_total{" << s.labels << ",phase=\"" << phaseName((SearchPhase)p)
+                    << "\"} " << s.stats.phaseAllocs[p] << "\n";
+            }
+        }
+        out << "# HELP chess_search_phase_allocated_bytes_total Heap bytes allocated per search phase.\n";
+        out << "# TYPE chess_search_phase_allocated_bytes_total counter\n";
+        for (const auto& s : series) {
+            for (int p = 0; p < PHASE_COUNT; p++) {
+                out << "chess_search_phase_allocated_bytes_total{" << s.labels << ",phase=\"" << phaseName((SearchPhase)p)
+                    << "\"} " << s.stats.phaseAllocBytes[p] << "\n";
+            }
+        }
+    }
+}
+
+inline bool writePrometheus(const std::string& path, const std::vector<LabeledStats>& series) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    writePrometheus(out, series);
+    return (bool)out;
+}
@@ -0,0 +1,105 @@
+// thread_pool.h
+// A fixed set of worker threads for the parallel graph kernels.
+// Kernels call run()/parallelFor() many times (e.g. once per BFS level), so
+// the threads are started once and woken for each call instead of being
+// created per call. The calling thread always takes part as worker 0.
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // threads <= 0: one per hardware thread
+    explicit ThreadPool(int threads = 0) {
+        if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+        count = threads;
+        for (int t = 1; t < count; t++) workers.emplace_back(&ThreadPool::workerLoop, this, t);
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quitting = true;
+            generation++;
+        }
+        wake.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return count; }
+
+    // Runs fn(tid) once on every worker, tid = 0 .. size()-1, and waits for all
+    void run(const std::function<void(int)>& fn) {
+        if (count == 1) {
+            fn(0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &fn;
+            pending = count - 1;
+            generation++;
+        }
+        wake.notify_all();
+        fn(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+        task = nullptr;
+    }
+
+    // Hands out [0, n) in chunks of `grain` to all workers: fn(begin, end, tid)
+    void parallelFor(size_t n, size_t grain, const std::function<void(size_t, size_t, int)>& fn) {
+        if (n == 0) return;
+        grain = std::max<size_t>(1, grain);
+        if (count == 1 || n <= grain) {
+            fn(0, n, 0);
+            return;
+        }
+        std::atomic<size_t> next{0};
+        run([&](int tid) {
+            while (true) {
+                size_t begin = next.fetch_add(grain, std::memory_order_relaxed);
+                if (begin >= n) break;
+                fn(begin, std::min(n, begin + grain), tid);
+            }
+        });
+    }
+
+private:
+    void workerLoop(int tid) {
+        size_t seen = 0;
+        while (true) {
+            const std::function<void(int)>* job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return generation != seen; });
+                seen = generation;
+                if (quitting) return;
+                job = task;
+            }
+            (*job)(tid);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--pending == 0) done.notify_one();
+            }
+        }
+    }
+
+    int count = 1;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(int)>* task = nullptr;
+    size_t generation = 0;
+    int pending = 0;
+    bool quitting = false;
+};
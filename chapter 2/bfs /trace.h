@@ -0,0 +1,183 @@
+// trace.h
+// Timeline zones written as Chrome trace-event JSON, readable in
+// chrome://tracing or https://ui.perfetto.dev (one track per thread).
+//
+//   TRACE_SCOPE("stepBFS");   // times the rest of the enclosing block
+//
+// Tracing starts with traceStart("trace.json") or by setting the environment
+// variable CHESS_TRACE=trace.json. Each thread appends to its own buffer, so a
+// zone takes no lock; the buffers are written out by traceFlush() and again at
+// program exit. While tracing is off a zone costs one atomic load, and
+// -DCHESS_TRACE=0 compiles the zones out entirely.
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef CHESS_TRACE
+#define CHESS_TRACE 1
+#endif
+
+// s as the inside of a JSON string: quotes, backslashes and control
+// characters escaped
+inline std::string traceJsonEscape(const char* s) {
+    std::string out;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += (char)c;
+        } else if (c < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", c);
+            out += code;
+        } else {
+            out += (char)c;
+        }
+    }
+    return out;
+}
+
+struct TraceEvent {
+    const char* name; // must be a string literal / outlive the tracer
+    uint64_t startNs;
+    uint64_t durNs;
+};
+
+struct TraceBuffer {
+    uint32_t tid = 0;
+    std::string threadName;
+    std::vector<TraceEvent> events;
+};
+
+class Tracer {
+public:
+    static Tracer& instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    bool isActive() const { return active.load(std::memory_order_relaxed); }
+
+    void start(const std::string& outPath) {
+        std::lock_guard<std::mutex> lock(mutex);
+        path = outPath;
+        active.store(true, std::memory_order_relaxed);
+    }
+
+    uint64_t nowNs() const {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - origin).count();
+    }
+
+    // The calling thread's buffer, created and registered on first use
+    TraceBuffer& threadBuffer() {
+        thread_local TraceBuffer* buffer = nullptr;
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock(mutex);
+            buffers.emplace_back(new TraceBuffer());
+            buffer = buffers.back().get();
+            buffer->tid = (uint32_t)buffers.size();
+            buffer->events.reserve(4096);
+        }
+        return *buffer;
+    }
+
+    // Writes everything recorded so far. Call it when the traced threads are
+    // idle (after joining workers); it also runs at exit.
+    bool flush() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (path.empty()) return true;
+        FILE* f = std::fopen(path.c_str(), "w");
+        if (!f) {
+            std::cerr << "trace: cannot write " << path << std::endl;
+            return false;
+        }
+        std::fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+        bool first = true;
+        for (const auto& b : buffers) {
+            if (!b->threadName.empty()) {
+                std::fprintf(f, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s\"}}",
+                             first ? "" : ",\n", b->tid, traceJsonEscape(b->threadName.c_str()).c_str());
+                first = false;
+            }
+            // Zone names repeat, so each distinct pointer is escaped once
+            const char* lastName = nullptr;
+            std::string escaped;
+            for (const auto& e : b->events) {
+                if (e.name != lastName) {
+                    lastName = e.name;
+                    escaped = traceJsonEscape(e.name);
+                }
+                std::fprintf(f, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                             first ? "" : ",\n", escaped.c_str(), b->tid, e.startNs / 1000.0, e.durNs / 1000.0);
+                first = false;
+            }
+        }
+        std::fprintf(f, "\n]}\n");
+        return std::fclose(f) == 0;
+    }
+
+    ~Tracer() {
+        if (active.load()) flush();
+    }
+
+private:
+    Tracer() : origin(std::chrono::steady_clock::now()) {
+        if (const char* env = std::getenv("CHESS_TRACE")) {
+            if (*env) {
+                path = env;
+                active.store(true);
+            }
+        }
+    }
+
+    std::atomic<bool> active{false};
+    std::chrono::steady_clock::time_point origin;
+    std::mutex mutex;
+    std::string path;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+};
+
+inline void traceStart(const std::string& path) { Tracer::instance().start(path); }
+inline bool traceFlush() { return Tracer::instance().flush(); }
+
+// Names the calling thread's track in the timeline
+inline void traceThreadName(const std::string& name) {
+    if (CHESS_TRACE && Tracer::instance().isActive()) Tracer::instance().threadBuffer().threadName = name;
+}
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* zoneName) {
+        if (Tracer::instance().isActive()) {
+            name = zoneName;
+            start = Tracer::instance().nowNs();
+        }
+    }
+    ~TraceScope() {
+        if (!name) return;
+        Tracer& t = Tracer::instance();
+        uint64_t end = t.nowNs();
+        t.threadBuffer().events.push_back({name, start, end - start});
+    }
+
+private:
+    const char* name = nullptr;
+    uint64_t start = 0;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#if CHESS_TRACE
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#endif
@@ -0,0 +1,103 @@
+// tree_diameter.h
+// Diameter of a tree stored as an undirected CsrGraph, from one BFS: the
+// BFS tree's entries are visited in reverse queue order, each adding its
+// subtree height to its parent's, and the longest path is the best sum of a
+// vertex's two tallest child subtrees. The BFS is the only pass that
+// follows edges; the bottom-up pass and the walk along the path read the
+// BFS tree by queue position, mostly in order, so on a randomly numbered
+// tree (where each BFS step is a chain of cache misses) the cost is about
+// half that of a double sweep.
+//
+// The BFS (csr_bfs.h) is iterative with a flat queue and a visited bitmap,
+// so it handles path-like trees of any depth, and each vertex is queued
+// exactly once (tree_diameter.py's bfs queues every neighbor, visited or
+// not). For a forest the result covers the component of the start vertex.
+//
+// Eccentricities use the endpoint property: the farthest vertex from any v
+// is one of the diameter endpoints a, b, so ecc(v) = max(d(a, v), d(b, v))
+// and three sweeps give every vertex's eccentricity in O(n). The center is
+// the middle vertex (or the two middle vertices) of the diameter path.
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "csr_bfs.h"
+#include "csr_graph.h"
+
+struct TreeDiameter {
+    uint32_t a = NO_VERTEX, b = NO_VERTEX; // endpoints
+    uint32_t length = 0;                   // edges on the path
+    std::vector<uint32_t> path;            // a .. b
+};
+
+// BFS over a tree with buffers reused between runs
+using TreeBfs = CsrBfs<CsrGraph>;
+
+inline TreeDiameter treeDiameter(const CsrGraph& g, uint32_t start = 0) {
+    TreeDiameter d;
+    if (g.n == 0) return d;
+    TreeBfs bfs(g);
+    uint32_t levels;
+    bfs.run(start, levels);
+
+    // Per queue entry: the height of its subtree so far and the entry at the
+    // bottom of it; children come after their parent, so reverse order
+    // finishes every subtree before it is added to its parent
+    size_t count = bfs.reachedCount();
+    std::vector<uint32_t> height(count, 0), deepest(count);
+    std::iota(deepest.begin(), deepest.end(), 0);
+    uint32_t endA = 0, endB = 0, top = 0;
+    for (size_t i = count - 1; i > 0; i--) {
+        uint32_t p = bfs.parentEntry(i);
+        if (height[p] + height[i] + 1 > d.length) {
+            d.length = height[p] + height[i] + 1;
+            endA = deepest[p];
+            endB = deepest[i];
+            top = p;
+        }
+        if (height[i] + 1 > height[p]) {
+            height[p] = height[i] + 1;
+            deepest[p] = deepest[i];
+        }
+    }
+
+    // endA up to top, then down to endB
+    for (uint32_t at = endA; at != top; at = bfs.parentEntry(at)) d.path.push_back(bfs.queued(at));
+    d.path.push_back(bfs.queued(top));
+    size_t down = d.path.size();
+    for (uint32_t at = endB; at != top; at = bfs.parentEntry(at)) d.path.push_back(bfs.queued(at));
+    std::reverse(d.path.begin() + down, d.path.end());
+    d.a = d.path.front();
+    d.b = d.path.back();
+    return d;
+}
+
+struct TreeEccentricity {
+    TreeDiameter diameter;
+    std::vector<uint32_t> ecc;   // per vertex, NO_VERTEX outside the component
+    uint32_t radius = 0;
+    std::vector<uint32_t> center; // one or two vertices
+};
+
+inline TreeEccentricity treeEccentricity(const CsrGraph& g, uint32_t start = 0) {
+    TreeEccentricity r;
+    if (g.n == 0) return r;
+    TreeBfs bfs(g);
+    TreeDiameter& d = r.diameter;
+    uint32_t levels;
+    std::vector<uint32_t> fromB(g.n);
+    r.ecc.assign(g.n, NO_VERTEX);
+    d.a = bfs.run(start, levels);
+    d.b = bfs.run(d.a, d.length, &r.ecc); // ecc holds d(a, v) for now
+    bfs.pathToLast(d.path);
+    bfs.run(d.b, levels, &fromB);
+    for (uint32_t v = 0; v < g.n; v++) {
+        if (r.ecc[v] != NO_VERTEX) r.ecc[v] = std::max(r.ecc[v], fromB[v]);
+    }
+    r.radius = (d.length + 1) / 2;
+    r.center.push_back(d.path[d.length / 2]);
+    if (d.length % 2) r.center.push_back(d.path[d.length / 2 + 1]);
+    return r;
+}
@@ -3,6 +3,12 @@ import pygame
 from math import hypot
 from collections import deque
 from typing import List, Tuple ,Callable
+# Optional native engines (see native_module.cpp); the N key uses them
+try:
+    import numpy as np
+    import bfs_native
+except ImportError:
+    bfs_native = None
 pygame.init()
 white = (255, 255, 255)
 green = (0, 255, 0)
@@ -87,6 +93,14 @@ def find_diameter(draw:Callable,selected_node:Node)->Tuple[Node, Node]:
     return (start,end)
     
 
+def find_diameter_native(selected_node:Node)->Tuple[Node, Node]:
+    index={node:i for i,node in enumerate(nodes)}
+    pairs=np.array([(index[edge.start],index[edge.end]) for edge in edges],dtype=np.uint32).reshape(-1,2)
+    a,b,length,path,distance=bfs_native.tree_diameter(pairs,len(nodes),index[selected_node])
+    for node,d in zip(nodes,distance.tolist()):
+        node.Visited=d!=bfs_native.NO_VERTEX
+        node.Distance=d if node.Visited else 0
+    return (nodes[a],nodes[b])
 
 
 def draw():
@@ -190,6 +204,12 @@ def main():
                     long_start,long_end=find_diameter(draw,selected_node)
                     selected_node=None
 
+            if event.type == pygame.KEYDOWN and event.key == pygame.K_n and bfs_native:
+
+                if selected_node:
+                    long_start,long_end=find_diameter_native(selected_node)
+                    selected_node=None
+
 
 
 
@@ -0,0 +1,176 @@
+// tree_lca.h
+// Constant-time lowest common ancestor and distance queries on a static
+// tree (or forest) stored as an undirected CsrGraph.
+//
+// The index is the Euler tour of the tree (every vertex written when entered
+// and again after each child returns) with each vertex's depth, so
+// lca(u, v) is the shallowest vertex on the tour between the first visits
+// of u and v: a range-minimum query. Two RMQ layouts are offered:
+//
+//   LCA_SPARSE_TABLE  minima of every power-of-two range; two lookups per
+//                     query, about 8 * log2(2n) bytes per tour entry
+//   LCA_BLOCKED       sparse table over 64-entry block minima, and inside a
+//                     block a 64-bit mask per entry of the positions that are
+//                     still suffix minima (a bit scan answers the in-block
+//                     part); about 16 bytes per tour entry
+//
+// Both also keep 12 bytes per vertex (first visit, depth, component).
+// Tours are built with an explicit stack, so path-like trees of any depth
+// are fine. Vertices in different components have no distance (NO_VERTEX).
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "csr_graph.h"
+#include "thread_pool.h"
+
+enum LcaLayout { LCA_SPARSE_TABLE, LCA_BLOCKED };
+
+class TreeLca {
+public:
+    TreeLca(const CsrGraph& g, LcaLayout layout = LCA_BLOCKED) : layout(layout) {
+        auto started = std::chrono::steady_clock::now();
+        buildTour(g);
+        if (layout == LCA_SPARSE_TABLE) {
+            buildSparse(tour, sparse);
+        } else {
+            buildBlocks();
+        }
+        buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+
+    uint32_t lca(uint32_t u, uint32_t v) const {
+        if (component[u] != component[v]) return NO_VERTEX;
+        uint32_t l = first[u], r = first[v];
+        if (l > r) std::swap(l, r);
+        return (uint32_t)rangeMin(l, r);
+    }
+
+    // Edges between u and v, NO_VERTEX if they are in different components
+    uint32_t distance(uint32_t u, uint32_t v) const {
+        uint32_t a = lca(u, v);
+        return a == NO_VERTEX ? NO_VERTEX : depth[u] + depth[v] - 2 * depth[a];
+    }
+
+    // out[i] = distance(queries[i]); split across the pool's workers
+    void distances(const std::vector<std::pair<uint32_t, uint32_t>>& queries, std::vector<uint32_t>& out,
+                   ThreadPool& pool) const {
+        out.resize(queries.size());
+        pool.parallelFor(queries.size(), 4096, [&](size_t b, size_t e, int) {
+            for (size_t i = b; i < e; i++) out[i] = distance(queries[i].first, queries[i].second);
+        });
+    }
+
+    uint32_t depthOf(uint32_t v) const { return depth[v]; }
+    double buildTime() const { return buildSeconds; }
+
+    size_t bytes() const {
+        size_t b = tour.size() * sizeof(uint64_t) + (first.size() + depth.size() + component.size()) * sizeof(uint32_t)
+                 + masks.size() * sizeof(uint64_t);
+        for (const auto& level : sparse) b += level.size() * sizeof(uint64_t);
+        return b;
+    }
+
+private:
+    static const int BLOCK = 64;
+
+    // Tour entries are (depth << 32 | vertex), so the smallest key is the
+    // shallowest vertex and min() needs no depth lookups
+    static uint64_t key(uint32_t d, uint32_t v) { return (uint64_t)d << 32 | v; }
+
+    void buildTour(const CsrGraph& g) {
+        first.assign(g.n, NO_VERTEX);
+        depth.assign(g.n, 0);
+        component.assign(g.n, NO_VERTEX);
+        tour.reserve(g.n ? 2 * (size_t)g.n - 1 : 0);
+        std::vector<std::pair<uint32_t, uint64_t>> stack; // vertex, next edge
+        uint32_t components = 0;
+        for (uint32_t root = 0; root < g.n; root++) {
+            if (component[root] != NO_VERTEX) continue;
+            component[root] = components;
+            first[root] = (uint32_t)tour.size();
+            tour.push_back(key(0, root));
+            stack.push_back({root, g.offsets[root]});
+            while (!stack.empty()) {
+                uint32_t u = stack.back().first;
+                uint64_t& next = stack.back().second;
+                if (next == g.offsets[u + 1]) {
+                    stack.pop_back();
+                    if (!stack.empty()) tour.push_back(key(depth[stack.back().first], stack.back().first));
+                    continue;
+                }
+                uint32_t v = g.targets[next++];
+                if (component[v] != NO_VERTEX) continue; // the parent (or a cycle in bad input)
+                component[v] = components;
+                depth[v] = depth[u] + 1;
+                first[v] = (uint32_t)tour.size();
+                tour.push_back(key(depth[v], v));
+                stack.push_back({v, g.offsets[v]});
+            }
+            components++;
+        }
+    }
+
+    static void buildSparse(const std::vector<uint64_t>& values, std::vector<std::vector<uint64_t>>& table) {
+        table.assign(1, values);
+        for (size_t span = 2; span <= values.size(); span *= 2) {
+            const auto& prev = table.back();
+            std::vector<uint64_t> level(values.size() - span + 1);
+            for (size_t i = 0; i < level.size(); i++) level[i] = std::min(prev[i], prev[i + span / 2]);
+            table.push_back(std::move(level));
+        }
+    }
+
+    static uint64_t sparseMin(const std::vector<std::vector<uint64_t>>& table, size_t l, size_t r) {
+        int k = 63 - __builtin_clzll(r - l + 1);
+        return std::min(table[k][l], table[k][r - ((size_t)1 << k) + 1]);
+    }
+
+    void buildBlocks() {
+        masks.resize(tour.size());
+        std::vector<uint64_t> blockMin((tour.size() + BLOCK - 1) / BLOCK);
+        for (size_t b = 0; b < blockMin.size(); b++) {
+            size_t start = b * BLOCK, end = std::min(tour.size(), start + BLOCK);
+            uint64_t stack = 0; // bit j: position start + j is a suffix minimum so far
+            for (size_t i = start; i < end; i++) {
+                while (stack) {
+                    int top = 63 - __builtin_clzll(stack);
+                    if (tour[start + top] <= tour[i]) break;
+                    stack &= ~(uint64_t(1) << top);
+                }
+                stack |= uint64_t(1) << (i - start);
+                masks[i] = stack;
+            }
+            blockMin[b] = tour[start + __builtin_ctzll(masks[end - 1])];
+        }
+        buildSparse(blockMin, sparse);
+    }
+
+    // Minimum over tour[l .. r] where both lie in one block
+    uint64_t inBlockMin(size_t l, size_t r) const {
+        size_t start = l - l % BLOCK;
+        uint64_t m = masks[r] & (~uint64_t(0) << (l - start));
+        return tour[start + __builtin_ctzll(m)];
+    }
+
+    uint64_t rangeMin(size_t l, size_t r) const {
+        if (layout == LCA_SPARSE_TABLE) return sparseMin(sparse, l, r);
+        size_t bl = l / BLOCK, br = r / BLOCK;
+        if (bl == br) return inBlockMin(l, r);
+        uint64_t m = std::min(inBlockMin(l, bl * BLOCK + BLOCK - 1), inBlockMin(br * BLOCK, r));
+        if (bl + 1 < br) m = std::min(m, sparseMin(sparse, bl + 1, br - 1));
+        return m;
+    }
+
+    LcaLayout layout;
+    std::vector<uint64_t> tour;
+    std::vector<uint32_t> first;     // tour position of each vertex's first visit
+    std::vector<uint32_t> depth;
+    std::vector<uint32_t> component;
+    std::vector<uint64_t> masks;     // LCA_BLOCKED only
+    std::vector<std::vector<uint64_t>> sparse; // over the tour or over block minima
+    double buildSeconds = 0.0;
+};
@@ -0,0 +1,719 @@
+// tree_tool.cpp
+// Command-line tree analytics on large trees (the native side of
+// tree_diameter.py, without the drawing and the pacing).
+//
+//   g++ -O2 -std=c++17 tree_tool.cpp -o tree_tool -lpthread
+//   ./tree_tool [--gen random|prufer|path|star|caterpillar] [--nodes N] [--seed N] [--shuffle]
+//               [--input edges.txt|file.edges] [--threads N] [--print-path]
+//               [--ecc] [--ecc-out file] [--verify]
+//               [--lca-queries N] [--lca-layout blocked|sparse]
+//               [--centroid-queries N]
+//   ./tree_tool --dynamic-ops N [--nodes N] [--seed N] [--verify]
+//   ./tree_tool --weighted [--max-length N] [--forest-cuts N] [--weighted-out file]
+//               [--nodes N] [--seed N] [--shuffle] [--input edges.txt] [--verify]
+//   ./tree_tool --editor-ops N [--nodes N] [--seed N] [--verify]
+//
+// The tree is either generated (graph_generators.h: a random recursive
+// tree, a uniform random labeled tree, a path, a star or a caterpillar with
+// a spine of a tenth of the nodes; ids relabeled randomly with --shuffle) or
+// read from a text file with one "u v" edge per line (edge_list_parser.h,
+// parsed in parallel; '#' and '%' lines are comments) or a binary edge file
+// from graph_gen --out. It prints the diameter with both endpoints and the
+// time of each step; --print-path also prints the vertices on the path.
+//
+// --ecc computes every vertex's eccentricity (tree_diameter.h, three sweeps)
+// and prints the radius and center; --ecc-out writes one eccentricity per
+// line, vertex order. --verify recomputes them with a BFS from every vertex
+// (small trees only) and exits with 1 on any difference.
+//
+// --lca-queries builds the Euler tour LCA index (tree_lca.h), reports its
+// build time and memory, and times that many random distance queries, one
+// at a time and as a batch over the thread pool. With --verify the answers
+// are also checked against BFS distances.
+//
+// --centroid-queries builds the centroid decomposition (centroid_decomposition.h)
+// and times that many random mark / unmark / nearest-marked operations, then
+// counts the vertex pairs within distance k for k = 1, 2, 4, ... up to the
+// diameter. With --verify nearest answers are checked by BFS and the pair
+// counts by a BFS from every vertex.
+//
+// --dynamic-ops runs N random edge insertions and deletions on a forest of
+// --nodes vertices with DynamicTreeDiameter (dynamic_tree_diameter.h),
+// asking for the diameter of the changed tree after each one, and reports
+// operations per second. --verify recomputes every answer from scratch.
+//
+// --weighted gives every edge a length (uniform in 1 .. --max-length, or a
+// third column in the --input file, default 1), removes --forest-cuts random
+// edges to make a forest, and computes every tree's weighted diameter, ends
+// and center in one batch (weighted_forest.h). --weighted-out writes one
+// "root vertices length a b center radius" line per tree; --verify checks
+// them against a traversal from every vertex on small forests.
+//
+// --editor-ops scatters --nodes nodes over a canvas (a random tree of edges
+// between them) in a GraphEditor (graph_editor.h) and replays N random edits
+// as the editor would see them: clicks, edge additions, node moves, node
+// deletions and insertions, and 800x600 viewport queries. It prints the
+// latency of each kind; --verify compares every click with a scan over all
+// nodes and checks the editor's internal links after every edit.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "centroid_decomposition.h"
+#include "csr_graph.h"
+#include "dynamic_tree_diameter.h"
+#include "edge_list_parser.h"
+#include "graph_editor.h"
+#include "graph_generators.h"
+#include "graph_reorder.h"
+#include "latency_histogram.h"
+#include "thread_pool.h"
+#include "tree_diameter.h"
+#include "tree_lca.h"
+#include "weighted_forest.h"
+
+struct Options {
+    std::string gen = "random";
+    uint32_t nodes = 1000000;
+    uint64_t seed = 1;
+    bool shuffle = false;
+    std::string input;
+    int threads = 0;
+    bool printPath = false;
+    bool ecc = false;
+    std::string eccOut;
+    bool verify = false;
+    uint64_t lcaQueries = 0;
+    uint64_t centroidQueries = 0;
+    LcaLayout lcaLayout = LCA_BLOCKED;
+    uint64_t dynamicOps = 0;
+    bool weighted = false;
+    uint32_t maxLength = 100;
+    uint32_t forestCuts = 0;
+    std::string weightedOut;
+    uint64_t editorOps = 0;
+};
+
+const uint32_t VERIFY_MAX_NODES = 20000;
+
+static double secondsSince(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+static EdgeSource treeSource(const Options& opt, ThreadPool& pool) {
+    if (opt.gen == "prufer") return pruferTreeSource(opt.nodes, opt.seed, pool);
+    if (opt.gen == "path") return pathSource(opt.nodes);
+    if (opt.gen == "star") return starSource(opt.nodes);
+    if (opt.gen == "caterpillar") return caterpillarSource(opt.nodes, std::max<uint32_t>(1, opt.nodes / 10), opt.seed);
+    return randomTreeSource(opt.nodes, opt.seed);
+}
+
+// "u v [length]" per line (edge_list_parser.h); a missing length is 1
+static bool loadWeightedEdgeList(const std::string& path, std::vector<WeightedEdge>& edges, uint32_t& n,
+                                 ThreadPool& pool) {
+    if (isEdgeFile(path)) {
+        std::cerr << path << ": binary edge files have no lengths, --weighted needs a text edge list" << std::endl;
+        return false;
+    }
+    std::vector<Edge> pairs;
+    std::vector<uint32_t> lengths;
+    if (!parseEdgeList(path, pairs, &lengths, n, pool)) return false;
+    edges.resize(pairs.size());
+    for (size_t i = 0; i < pairs.size(); i++) edges[i] = {pairs[i].u, pairs[i].v, lengths[i]};
+    return true;
+}
+
+// Eccentricities by a BFS from every vertex, O(n^2)
+static bool verifyEccentricity(const CsrGraph& g, const TreeEccentricity& r) {
+    TreeBfs bfs(g);
+    std::vector<uint32_t> dist(g.n);
+    for (uint32_t v = 0; v < g.n; v++) {
+        if (r.ecc[v] == NO_VERTEX) continue;
+        uint32_t ecc;
+        bfs.run(v, ecc, &dist);
+        if (ecc != r.ecc[v]) {
+            std::cerr << "vertex " << v << ": eccentricity " << r.ecc[v] << ", by brute force " << ecc << std::endl;
+            return false;
+        }
+    }
+    uint32_t radius = NO_VERTEX;
+    for (uint32_t e : r.ecc) radius = std::min(radius, e);
+    for (uint32_t c : r.center) {
+        if (r.ecc[c] != radius) {
+            std::cerr << "center " << c << " has eccentricity " << r.ecc[c] << ", radius is " << radius << std::endl;
+            return false;
+        }
+    }
+    if (radius != r.radius) {
+        std::cerr << "radius " << r.radius << ", by brute force " << radius << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Distances from a few sources by BFS against the LCA index
+static bool verifyLca(const CsrGraph& g, const TreeLca& lca, uint64_t seed) {
+    TreeBfs bfs(g);
+    std::vector<uint32_t> dist(g.n);
+    SplitMix64 rng(seed);
+    for (int s = 0; s < 16; s++) {
+        uint32_t src = (uint32_t)rng.below(g.n), levels;
+        std::fill(dist.begin(), dist.end(), NO_VERTEX);
+        bfs.run(src, levels, &dist);
+        for (uint32_t v = 0; v < g.n; v++) {
+            if (lca.distance(src, v) != dist[v]) {
+                std::cerr << "distance " << src << "-" << v << ": index " << (int64_t)lca.distance(src, v)
+                          << ", BFS " << (int64_t)dist[v] << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void runLcaQueries(const CsrGraph& g, const Options& opt, ThreadPool& pool, bool& ok) {
+    TreeLca lca(g, opt.lcaLayout);
+    std::printf("lca_layout: %s\nlca_build_seconds: %.6f\nlca_bytes: %zu\n",
+                opt.lcaLayout == LCA_SPARSE_TABLE ? "sparse" : "blocked", lca.buildTime(), lca.bytes());
+
+    std::vector<std::pair<uint32_t, uint32_t>> queries(opt.lcaQueries);
+    SplitMix64 rng(opt.seed ^ 0x1caULL);
+    for (auto& q : queries) q = {(uint32_t)rng.below(g.n), (uint32_t)rng.below(g.n)};
+
+    auto t = std::chrono::steady_clock::now();
+    uint64_t sum = 0;
+    for (const auto& q : queries) sum += lca.distance(q.first, q.second);
+    double single = secondsSince(t);
+
+    std::vector<uint32_t> out;
+    t = std::chrono::steady_clock::now();
+    lca.distances(queries, out, pool);
+    double batch = secondsSince(t);
+
+    double n = (double)std::max<uint64_t>(1, queries.size());
+    std::printf("lca_queries: %llu\nlca_ns_per_query: %.1f\nlca_batch_ns_per_query: %.1f\nlca_mean_distance: %.3f\n",
+                (unsigned long long)queries.size(), single * 1e9 / n, batch * 1e9 / n, sum / n);
+    if (opt.verify) {
+        ok = verifyLca(g, lca, opt.seed);
+        if (ok) std::printf("lca_verify: passed\n");
+    }
+}
+
+// Nearest marked vertex by BFS, ties to the smaller id
+static NearestMarked bfsNearestMarked(const CsrGraph& g, const std::vector<bool>& marked, uint32_t v,
+                                      std::vector<uint32_t>& dist, TreeBfs& bfs) {
+    uint32_t levels;
+    std::fill(dist.begin(), dist.end(), NO_VERTEX);
+    bfs.run(v, levels, &dist);
+    NearestMarked best;
+    for (uint32_t u = 0; u < g.n; u++) {
+        if (marked[u] && dist[u] != NO_VERTEX && dist[u] < best.distance) best = {dist[u], u};
+    }
+    return best;
+}
+
+static void runCentroidQueries(const CsrGraph& g, const Options& opt, uint32_t diameter, ThreadPool& pool, bool& ok) {
+    CentroidIndex index(g, pool);
+    std::printf("centroid_levels: %u\ncentroid_build_seconds: %.6f\ncentroid_bytes: %zu\n", index.levels(),
+                index.buildTime(), index.bytes());
+
+    bool verify = opt.verify && g.n <= VERIFY_MAX_NODES;
+    TreeBfs bfs(g);
+    std::vector<uint32_t> dist(g.n);
+    std::vector<bool> marked(g.n, false);
+    std::vector<uint32_t> markedList;
+    SplitMix64 rng(opt.seed ^ 0xce17ULL);
+    uint64_t nearest = 0, found = 0;
+    auto t = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < opt.centroidQueries; i++) {
+        uint64_t kind = rng.below(6);
+        uint32_t v = (uint32_t)rng.below(g.n);
+        if (kind < 2) {
+            index.mark(v);
+            if (!marked[v]) markedList.push_back(v);
+            marked[v] = true;
+        } else if (kind < 3 && !markedList.empty()) {
+            size_t k = (size_t)rng.below(markedList.size());
+            index.unmark(markedList[k]);
+            marked[markedList[k]] = false;
+            markedList[k] = markedList.back();
+            markedList.pop_back();
+        } else {
+            NearestMarked got = index.nearestMarked(v);
+            nearest++;
+            found += got.vertex != NO_VERTEX;
+            if (!verify) continue;
+            NearestMarked want = bfsNearestMarked(g, marked, v, dist, bfs);
+            if (got.distance != want.distance || (got.vertex != NO_VERTEX && !marked[got.vertex])) {
+                std::cerr << "nearest marked to " << v << ": " << (int64_t)got.vertex << " at " << (int64_t)got.distance
+                          << ", by BFS " << (int64_t)want.vertex << " at " << (int64_t)want.distance << std::endl;
+                ok = false;
+                return;
+            }
+        }
+    }
+    double secs = secondsSince(t);
+    std::printf("centroid_operations: %llu\nnearest_queries: %llu\nnearest_found: %llu\n",
+                (unsigned long long)opt.centroidQueries, (unsigned long long)nearest, (unsigned long long)found);
+    // Under --verify the loop time is mostly the BFS checks
+    if (!verify) {
+        std::printf("centroid_ns_per_operation: %.1f\n", secs * 1e9 / std::max<uint64_t>(1, opt.centroidQueries));
+    }
+    std::printf("marked_vertices: %zu\ncentroid_heap_entries: %llu\n", markedList.size(),
+                (unsigned long long)index.heapEntries());
+
+    // Pairs within k; brute force counts every distance once per vertex
+    std::vector<uint64_t> byDistance;
+    if (verify) {
+        byDistance.assign(g.n, 0);
+        for (uint32_t v = 0; v < g.n; v++) {
+            uint32_t levels;
+            std::fill(dist.begin(), dist.end(), NO_VERTEX);
+            bfs.run(v, levels, &dist);
+            for (uint32_t u = v + 1; u < g.n; u++) {
+                if (dist[u] != NO_VERTEX) byDistance[dist[u]]++;
+            }
+        }
+        for (size_t d = 1; d < byDistance.size(); d++) byDistance[d] += byDistance[d - 1];
+    }
+    for (uint32_t k = 1;; k *= 2) {
+        k = std::min(k, std::max(diameter, 1u));
+        t = std::chrono::steady_clock::now();
+        uint64_t pairs = index.pairsWithin(k);
+        std::printf("pairs_within_%u: %llu (%.6fs)\n", k, (unsigned long long)pairs, secondsSince(t));
+        if (verify && pairs != byDistance[std::min<size_t>(k, g.n - 1)]) {
+            std::cerr << "pairs within " << k << ": " << pairs << ", by BFS "
+                      << byDistance[std::min<size_t>(k, g.n - 1)] << std::endl;
+            ok = false;
+            return;
+        }
+        if (k >= diameter) break;
+    }
+    if (verify) std::printf("centroid_verify: passed\n");
+}
+
+// The diameter of v's tree by double sweep over the current edges
+static bool checkDynamic(uint32_t n, const std::vector<Edge>& edges, uint32_t v, const DynamicDiameter& got,
+                         ThreadPool& pool) {
+    CsrGraph g = buildCsr(n, edges, pool);
+    TreeBfs bfs(g);
+    std::vector<uint32_t> dist(n, NO_VERTEX);
+    uint32_t length;
+    uint32_t a = bfs.run(v, length);
+    bfs.run(a, length);
+    bfs.run(got.a, a, &dist);
+    if (got.length != length || dist[v] == NO_VERTEX || dist[got.b] != got.length) {
+        std::cerr << "tree of " << v << ": diameter " << got.length << " (" << got.a << "-" << got.b
+                  << "), by double sweep " << length << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static int runDynamic(const Options& opt, ThreadPool& pool) {
+    uint32_t n = opt.nodes;
+    if (opt.verify && n > VERIFY_MAX_NODES) {
+        std::cerr << "--verify rebuilds the forest per operation, use at most " << VERIFY_MAX_NODES << " nodes" << std::endl;
+        return 2;
+    }
+    DynamicTreeDiameter forest(n);
+    std::vector<Edge> edges; // current edges, for cuts and --verify
+    SplitMix64 rng(opt.seed);
+    uint64_t links = 0, cuts = 0, rejected = 0, longest = 0;
+
+    auto t = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < opt.dynamicOps; i++) {
+        uint32_t touched;
+        // Mostly links so the trees grow large; a cut is a random existing edge
+        if (edges.empty() || rng.below(10) < 7) {
+            uint32_t u = (uint32_t)rng.below(n), v = (uint32_t)rng.below(n);
+            touched = u;
+            if (forest.link(u, v)) {
+                edges.push_back({u, v});
+                links++;
+            } else {
+                rejected++;
+            }
+        } else {
+            size_t k = (size_t)rng.below(edges.size());
+            forest.cut(edges[k].u, edges[k].v);
+            touched = edges[k].u;
+            edges[k] = edges.back();
+            edges.pop_back();
+            cuts++;
+        }
+        DynamicDiameter d = forest.diameter(touched);
+        longest = std::max<uint64_t>(longest, d.length);
+        if (opt.verify && !checkDynamic(n, edges, touched, d, pool)) return 1;
+    }
+    double secs = secondsSince(t);
+
+    std::printf("vertices: %u\noperations: %llu\nlinks: %llu\ncuts: %llu\nrejected_links: %llu\n", n,
+                (unsigned long long)opt.dynamicOps, (unsigned long long)links, (unsigned long long)cuts,
+                (unsigned long long)rejected);
+    std::printf("longest_diameter_seen: %llu\n", (unsigned long long)longest);
+    // Under --verify the loop time is mostly checkDynamic's rebuilds
+    if (opt.verify) {
+        std::printf("verify: passed\n");
+    } else {
+        std::printf("dynamic_seconds: %.6f\nops_per_second: %.0f\n", secs, opt.dynamicOps / std::max(secs, 1e-9));
+    }
+    return 0;
+}
+
+// Weighted eccentricities by a traversal from every vertex, O(n^2)
+static bool verifyWeighted(uint32_t n, const std::vector<WeightedEdge>& edges, const ForestDiameters& r) {
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> adj(n);
+    for (const auto& e : edges) {
+        if (e.u == e.v) continue;
+        adj[e.u].push_back({e.v, e.length});
+        adj[e.v].push_back({e.u, e.length});
+    }
+    std::vector<uint64_t> longest(r.components.size(), 0), shortest(r.components.size(), UINT64_MAX);
+    std::vector<uint64_t> dist(n);
+    std::vector<uint32_t> stack;
+    for (uint32_t src = 0; src < n; src++) {
+        std::fill(dist.begin(), dist.end(), UINT64_MAX);
+        dist[src] = 0;
+        stack.assign(1, src);
+        uint64_t ecc = 0;
+        while (!stack.empty()) {
+            uint32_t u = stack.back();
+            stack.pop_back();
+            ecc = std::max(ecc, dist[u]);
+            for (const auto& [v, length] : adj[u]) {
+                if (dist[v] != UINT64_MAX) continue;
+                dist[v] = dist[u] + length;
+                stack.push_back(v);
+            }
+        }
+        const ComponentDiameter& c = r.components[r.componentOf[src]];
+        longest[r.componentOf[src]] = std::max(longest[r.componentOf[src]], ecc);
+        shortest[r.componentOf[src]] = std::min(shortest[r.componentOf[src]], ecc);
+        if (src == c.center && ecc != c.radius) {
+            std::cerr << "tree " << c.root << ": center " << src << " has eccentricity " << ecc << ", reported "
+                      << c.radius << std::endl;
+            return false;
+        }
+        if (src == c.a && dist[c.b] != c.length) {
+            std::cerr << "tree " << c.root << ": ends " << c.a << "-" << c.b << " are " << dist[c.b]
+                      << " apart, reported " << c.length << std::endl;
+            return false;
+        }
+    }
+    for (size_t i = 0; i < r.components.size(); i++) {
+        const ComponentDiameter& c = r.components[i];
+        if (longest[i] != c.length || shortest[i] != c.radius) {
+            std::cerr << "tree " << c.root << ": diameter " << c.length << " radius " << c.radius
+                      << ", by brute force " << longest[i] << " and " << shortest[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static int runWeighted(const Options& opt, ThreadPool& pool) {
+    auto t = std::chrono::steady_clock::now();
+    std::vector<WeightedEdge> edges;
+    uint32_t n = opt.nodes;
+    if (!opt.input.empty()) {
+        if (!loadWeightedEdgeList(opt.input, edges, n, pool)) return 1;
+    } else {
+        std::vector<Edge> tree = collectEdges(treeSource(opt, pool), pool);
+        SplitMix64 rng(opt.seed ^ 0x7e16ULL);
+        for (uint32_t k = 0; k < opt.forestCuts && !tree.empty(); k++) {
+            size_t i = (size_t)rng.below(tree.size());
+            tree[i] = tree.back();
+            tree.pop_back();
+        }
+        edges.resize(tree.size());
+        for (size_t i = 0; i < tree.size(); i++) {
+            edges[i] = {tree[i].u, tree[i].v, (uint32_t)rng.below(opt.maxLength) + 1};
+        }
+    }
+    if (opt.shuffle) {
+        std::vector<uint32_t> perm = randomPermutation(n, opt.seed ^ 0x5eedULL);
+        for (auto& e : edges) e = {perm[e.u], perm[e.v], e.length};
+    }
+    double loadTime = secondsSince(t);
+
+    t = std::chrono::steady_clock::now();
+    WeightedForest forest(n, edges, pool);
+    double buildTime = secondsSince(t);
+    ForestDiameters r = forest.solve();
+
+    const ComponentDiameter* widest = nullptr;
+    for (const auto& c : r.components) {
+        if (!widest || c.length > widest->length) widest = &c;
+    }
+    if (!r.isForest) std::cerr << "warning: the input has cycles, distances follow a spanning tree" << std::endl;
+    std::printf("vertices: %u\nedges: %zu\ntrees: %zu\nforest_bytes: %zu\n", n, edges.size(), r.components.size(),
+                forest.bytes());
+    std::printf("load_seconds: %.6f\nbuild_seconds: %.6f\nsolve_seconds: %.6f\n", loadTime, buildTime, r.seconds);
+    if (widest) {
+        std::printf("longest_diameter: %llu\nlongest_tree: %u\nlongest_tree_vertices: %u\nendpoints: %u %u\n"
+                    "center: %u\nradius: %llu\n",
+                    (unsigned long long)widest->length, widest->root, widest->vertices, widest->a, widest->b,
+                    widest->center, (unsigned long long)widest->radius);
+    }
+    if (!opt.weightedOut.empty()) {
+        std::ofstream out(opt.weightedOut);
+        for (const auto& c : r.components) {
+            out << c.root << " " << c.vertices << " " << c.length << " " << c.a << " " << c.b << " " << c.center
+                << " " << c.radius << "\n";
+        }
+        if (!out) {
+            std::cerr << "Failed to write " << opt.weightedOut << std::endl;
+            return 1;
+        }
+    }
+    if (opt.verify) {
+        if (n > VERIFY_MAX_NODES) {
+            std::cerr << "--verify is O(n^2), skipped above " << VERIFY_MAX_NODES << " vertices" << std::endl;
+        } else {
+            if (!verifyWeighted(n, edges, r)) return 1;
+            std::printf("verify: passed\n");
+        }
+    }
+    return 0;
+}
+
+// What get_node_at_pos does: every node, closest one wins here
+static uint32_t scanNodeAt(const GraphEditor& ed, float x, float y) {
+    uint32_t best = NO_VERTEX;
+    float r = ed.nodeRadius(), bestDist = r * r;
+    for (uint32_t id = 0; id < ed.idBound(); id++) {
+        if (!ed.isAlive(id)) continue;
+        float dx = ed.nodeX(id) - x, dy = ed.nodeY(id) - y, d = dx * dx + dy * dy;
+        if (d < bestDist || (d == bestDist && id < best)) {
+            best = id;
+            bestDist = d;
+        }
+    }
+    return best;
+}
+
+static int runEditor(const Options& opt, ThreadPool& pool) {
+    enum { PICK, LINK, MOVE, REMOVE, INSERT, VIEW, KINDS };
+    const char* names[KINDS] = {"pick", "add_edge", "move_node", "delete_node", "add_node", "viewport"};
+    const float SPACING = 40.0f, VIEW_W = 800.0f, VIEW_H = 600.0f;
+
+    uint32_t n = opt.nodes;
+    float side = SPACING * std::sqrt((float)n);
+    SplitMix64 rng(opt.seed);
+    auto coord = [&]() { return (float)(rng.nextDouble() * side); };
+
+    auto t = std::chrono::steady_clock::now();
+    GraphEditor ed;
+    for (uint32_t v = 0; v < n; v++) ed.addNode(coord(), coord());
+    for (const Edge& e : randomTreeEdges(n, opt.seed, pool)) ed.addEdge(e.u, e.v);
+    double buildTime = secondsSince(t);
+
+    std::vector<LatencyHistogram> hist(KINDS);
+    std::vector<uint32_t> visible;
+    uint32_t selected = NO_VERTEX;
+    uint64_t hits = 0, shown = 0;
+    for (uint64_t i = 0; i < opt.editorOps; i++) {
+        int kind = (int)rng.below(20);
+        kind = kind < 10 ? PICK : kind < 13 ? LINK : kind < 15 ? MOVE : kind < 17 ? REMOVE : kind < 19 ? INSERT : VIEW;
+        // Clicks land near an existing node half the time
+        uint32_t target = (uint32_t)rng.below(ed.idBound());
+        float x = coord(), y = coord();
+        if (rng.below(2) && ed.isAlive(target)) {
+            x = ed.nodeX(target) + (float)(rng.nextDouble() - 0.5) * ed.nodeRadius();
+            y = ed.nodeY(target) + (float)(rng.nextDouble() - 0.5) * ed.nodeRadius();
+        }
+        auto started = std::chrono::steady_clock::now();
+        switch (kind) {
+        case PICK:
+            selected = ed.nodeAt(x, y);
+            hits += selected != NO_VERTEX;
+            break;
+        case LINK: {
+            uint32_t other = ed.nodeAt(x, y);
+            if (selected != NO_VERTEX && other != NO_VERTEX && ed.isAlive(selected)) ed.addEdge(selected, other);
+            break;
+        }
+        case MOVE:
+            if (ed.isAlive(target)) ed.moveNode(target, x, y);
+            break;
+        case REMOVE:
+            ed.removeNode(target);
+            break;
+        case INSERT:
+            if (ed.nodeAt(x, y) == NO_VERTEX) ed.addNode(x, y);
+            break;
+        case VIEW:
+            visible.clear();
+            ed.nodesIn(x, y, x + VIEW_W, y + VIEW_H, visible);
+            shown += visible.size();
+            break;
+        }
+        hist[kind].record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now() - started).count());
+
+        if (!opt.verify) continue;
+        if (kind == PICK && selected != scanNodeAt(ed, x, y)) {
+            std::cerr << "click at " << x << "," << y << ": picked " << (int64_t)selected << ", scan finds "
+                      << (int64_t)scanNodeAt(ed, x, y) << std::endl;
+            return 1;
+        }
+        if (!ed.consistent()) {
+            std::cerr << "editor links broken after " << names[kind] << " (edit " << i << ")" << std::endl;
+            return 1;
+        }
+    }
+
+    std::printf("nodes: %u\nedges: %zu\nbuild_seconds: %.6f\nedits: %llu\npick_hits: %llu\nmean_visible: %.1f\n",
+                ed.nodeCount(), ed.edgeList().size(), buildTime, (unsigned long long)opt.editorOps,
+                (unsigned long long)hits, hist[VIEW].count() ? (double)shown / hist[VIEW].count() : 0.0);
+    for (int k = 0; k < KINDS; k++) writeLatencyLine(std::cout, names[k], hist[k]);
+    if (opt.verify) std::printf("verify: passed\n");
+    return 0;
+}
+
+static bool parseArgs(int argc, char** argv, Options& o) {
+    for (int i = 1; i < argc; i++) {
+        bool more = i + 1 < argc;
+        if (std::strcmp(argv[i], "--gen") == 0 && more) o.gen = argv[++i];
+        else if (std::strcmp(argv[i], "--nodes") == 0 && more) o.nodes = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--seed") == 0 && more) o.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--shuffle") == 0) o.shuffle = true;
+        else if (std::strcmp(argv[i], "--input") == 0 && more) o.input = argv[++i];
+        else if (std::strcmp(argv[i], "--threads") == 0 && more) o.threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--print-path") == 0) o.printPath = true;
+        else if (std::strcmp(argv[i], "--ecc") == 0) o.ecc = true;
+        else if (std::strcmp(argv[i], "--ecc-out") == 0 && more) { o.ecc = true; o.eccOut = argv[++i]; }
+        else if (std::strcmp(argv[i], "--verify") == 0) { o.ecc = true; o.verify = true; }
+        else if (std::strcmp(argv[i], "--lca-queries") == 0 && more) o.lcaQueries = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--centroid-queries") == 0 && more) o.centroidQueries = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--dynamic-ops") == 0 && more) o.dynamicOps = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--weighted") == 0) o.weighted = true;
+        else if (std::strcmp(argv[i], "--editor-ops") == 0 && more) o.editorOps = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--max-length") == 0 && more) o.maxLength = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--forest-cuts") == 0 && more) o.forestCuts = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--weighted-out") == 0 && more) { o.weighted = true; o.weightedOut = argv[++i]; }
+        else if (std::strcmp(argv[i], "--lca-layout") == 0 && more) {
+            std::string layout = argv[++i];
+            if (layout != "blocked" && layout != "sparse") return false;
+            o.lcaLayout = layout == "sparse" ? LCA_SPARSE_TABLE : LCA_BLOCKED;
+        }
+        else return false;
+    }
+    bool knownGen = o.gen == "random" || o.gen == "prufer" || o.gen == "path" || o.gen == "star" || o.gen == "caterpillar";
+    return knownGen && o.nodes >= 1 && o.nodes < NO_VERTEX && o.maxLength >= 1;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::cerr << "usage: " << argv[0] << " [--gen random|prufer|path|star|caterpillar] [--nodes N] [--seed N] [--shuffle]"
+                  << " [--input edges.txt|file.edges] [--threads N] [--print-path] [--ecc] [--ecc-out file] [--verify]"
+                  << " [--lca-queries N] [--lca-layout blocked|sparse] [--centroid-queries N] [--dynamic-ops N]"
+                  << " [--weighted] [--max-length N] [--forest-cuts N] [--weighted-out file] [--editor-ops N]"
+                  << std::endl;
+        return 2;
+    }
+    ThreadPool pool(opt.threads);
+    if (opt.dynamicOps > 0) return runDynamic(opt, pool);
+    if (opt.weighted) return runWeighted(opt, pool);
+    if (opt.editorOps > 0) return runEditor(opt, pool);
+
+    auto t = std::chrono::steady_clock::now();
+    CsrGraph g;
+    double loadTime, buildTime;
+    if (!opt.input.empty() && !isEdgeFile(opt.input)) {
+        // Straight from the parsed chunks; --shuffle relabels the built graph
+        EdgeListStats stats;
+        if (!loadEdgeListCsr(opt.input, g, pool, 0, &stats)) return 1;
+        loadTime = stats.parseSeconds;
+        t = std::chrono::steady_clock::now();
+        if (opt.shuffle) g = permuteCsr(g, VertexPermutation::fromRank(randomPermutation(g.n, opt.seed ^ 0x5eedULL)));
+        buildTime = stats.buildSeconds + secondsSince(t);
+    } else {
+        std::vector<Edge> edges;
+        uint32_t n = opt.nodes;
+        if (!opt.input.empty()) {
+            if (!readEdgeFile(opt.input, edges, n)) return 1;
+        } else {
+            edges = collectEdges(treeSource(opt, pool), pool);
+        }
+        if (opt.shuffle) {
+            std::vector<uint32_t> perm = randomPermutation(n, opt.seed ^ 0x5eedULL);
+            for (auto& e : edges) e = {perm[e.u], perm[e.v]};
+        }
+        loadTime = secondsSince(t);
+        t = std::chrono::steady_clock::now();
+        g = buildCsr(n, edges, pool);
+        buildTime = secondsSince(t);
+    }
+    if (g.n == 0) {
+        std::cerr << "empty tree" << std::endl;
+        return 1;
+    }
+
+    t = std::chrono::steady_clock::now();
+    TreeDiameter d = treeDiameter(g);
+    double diameterTime = secondsSince(t);
+
+    TreeEccentricity ecc;
+    double eccTime = 0.0;
+    if (opt.ecc) {
+        t = std::chrono::steady_clock::now();
+        ecc = treeEccentricity(g);
+        eccTime = secondsSince(t);
+    }
+
+    if (g.arcs() / 2 != (uint64_t)g.n - 1) {
+        std::cerr << "warning: " << g.arcs() / 2 << " edges for " << g.n
+                  << " vertices, not a tree; results are for the component of vertex 0" << std::endl;
+    }
+    std::printf("vertices: %u\nedges: %llu\ngraph_bytes: %zu\n", g.n, (unsigned long long)(g.arcs() / 2), g.bytes());
+    std::printf("load_seconds: %.6f\nbuild_seconds: %.6f\n", loadTime, buildTime);
+    std::printf("diameter: %u\nendpoints: %u %u\ndiameter_seconds: %.6f\n", d.length, d.a, d.b, diameterTime);
+    if (opt.printPath) {
+        std::printf("path:");
+        for (uint32_t v : d.path) std::printf(" %u", v);
+        std::printf("\n");
+    }
+    if (opt.lcaQueries > 0) {
+        bool ok = true;
+        runLcaQueries(g, opt, pool, ok);
+        if (!ok) return 1;
+    }
+    if (opt.centroidQueries > 0) {
+        bool ok = true;
+        runCentroidQueries(g, opt, d.length, pool, ok);
+        if (!ok) return 1;
+    }
+    if (!opt.ecc) return 0;
+
+    std::printf("radius: %u\ncenter:", ecc.radius);
+    for (uint32_t c : ecc.center) std::printf(" %u", c);
+    std::printf("\necc_seconds: %.6f\n", eccTime);
+    if (!opt.eccOut.empty()) {
+        std::ofstream out(opt.eccOut);
+        for (uint32_t e : ecc.ecc) out << (e == NO_VERTEX ? -1 : (int64_t)e) << "\n";
+        if (!out) {
+            std::cerr << "Failed to write " << opt.eccOut << std::endl;
+            return 1;
+        }
+    }
+    if (opt.verify) {
+        if (g.n > VERIFY_MAX_NODES) {
+            std::cerr << "--verify is O(n^2), skipped above " << VERIFY_MAX_NODES << " vertices" << std::endl;
+        } else {
+            if (!verifyEccentricity(g, ecc)) return 1;
+            std::printf("verify: passed\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,353 @@
+// verify_engines.cpp
+// Differential tester: every engine in chess_search.h against the reference
+// engine (stepBFS semantics) on seeded random boards, pieces, obstacle layouts
+// and query pairs.
+//
+//   g++ -O2 -std=c++17 verify_engines.cpp -o verify_engines -lpthread
+//   ./verify_engines [--cases N] [--seed N]
+//
+// For every case the distances must match and every returned path must be a
+// legal sequence of moves from start to goal of exactly that length. Each
+// engine is one instance kept across all cases, as a server would keep it,
+// so the state it carries between queries (epochs, grow-only buffers, the
+// CSR engine's exported graphs) is compared too: cases mix fresh boards of
+// interleaved sizes, new queries on the previous board and the previous
+// board with a few squares flipped. The first failing case is shrunk
+// (obstacles removed, board cropped) on fresh engines while it still fails,
+// printed, and the program exits with 1; a case that only fails after
+// earlier ones is printed with the case before it.
+//
+// Then the batch API (chess_batch.h) runs a seeded query list on several
+// threads with per-piece latency histograms and periodic snapshots. Every
+// distance must match the reference, the merged histograms and
+// batchStatsByPiece() must count every query once, and the snapshots and the
+// Prometheus text must carry those counts. Exit code 0 means all passed.
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "chess_batch.h"
+#include "chess_moves.h"
+#include "chess_search.h"
+#include "search_stats.h"
+
+struct TestCase {
+    Board board;
+    PieceType piece;
+    Point start;
+    Point goal;
+};
+
+const int MAX_SIZE = 20;
+const int LARGE_SIZE = 48;   // an occasional bigger board, to make the buffers grow
+const int MAX_FLIPS = 3;     // squares changed on the previous board
+
+using Engines = std::vector<std::unique_ptr<SearchEngine>>;
+
+// One instance of every engine but the reference
+static Engines makeEngines() {
+    Engines engines;
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        if (e != ENGINE_REFERENCE) engines.push_back(makeEngine((EngineType)e));
+    }
+    return engines;
+}
+
+// Empty string when the path is a valid answer for the case and distance
+static std::string checkPath(const TestCase& c, const SearchResult& r) {
+    if (r.distance < 0) return r.path.empty() ? "" : "path returned for an unreachable goal";
+    if ((int)r.path.size() != r.distance + 1) return "path length does not match distance";
+    if (r.path.front() != c.start) return "path does not begin at start";
+    if (r.path.back() != c.goal) return "path does not end at goal";
+    std::vector<Point> moves;
+    for (size_t i = 0; i + 1 < r.path.size(); i++) {
+        moves.clear();
+        generateMoves(c.board, c.piece, r.path[i], moves);
+        bool legal = false;
+        for (const auto& m : moves) legal = legal || m == r.path[i + 1];
+        if (!legal) return "illegal move in path at step " + std::to_string(i);
+    }
+    return "";
+}
+
+// Empty string when every engine agrees with the reference on this case
+static std::string runCase(const TestCase& c, Engines& engines) {
+    ReferenceEngine reference;
+    SearchResult expected = reference.search(c.board, c.piece, c.start, c.goal);
+    std::string err = checkPath(c, expected);
+    if (!err.empty()) return std::string("reference: ") + err;
+
+    for (auto& engine : engines) {
+        SearchResult got = engine->search(c.board, c.piece, c.start, c.goal);
+        if (got.distance != expected.distance) {
+            return std::string(engine->name()) + ": distance " + std::to_string(got.distance)
+                 + ", reference " + std::to_string(expected.distance);
+        }
+        err = checkPath(c, got);
+        if (!err.empty()) return std::string(engine->name()) + ": " + err;
+    }
+    return "";
+}
+
+// The same on engines that have answered nothing before
+static std::string runFresh(const TestCase& c) {
+    Engines engines = makeEngines();
+    return runCase(c, engines);
+}
+
+static void randomQuery(TestCase& c, std::mt19937& rng) {
+    c.piece = (PieceType)std::uniform_int_distribution<int>(0, PIECE_COUNT - 1)(rng);
+    std::uniform_int_distribution<int> coord(0, c.board.size - 1);
+    c.start = {coord(rng), coord(rng)};
+    c.goal = {coord(rng), coord(rng)};
+    c.board.blocked[c.board.index(c.start)] = 0; // the piece stands on start
+    c.board.touch();
+}
+
+static TestCase randomCase(std::mt19937& rng) {
+    TestCase c;
+    bool large = std::uniform_int_distribution<int>(0, 7)(rng) == 0;
+    c.board.size = std::uniform_int_distribution<int>(1, large ? LARGE_SIZE : MAX_SIZE)(rng);
+    double density = std::uniform_real_distribution<double>(0.0, 0.5)(rng);
+    c.board.blocked.assign(c.board.cells(), 0);
+    std::bernoulli_distribution block(density);
+    for (auto& b : c.board.blocked) b = block(rng) ? 1 : 0;
+    randomQuery(c, rng);
+    return c;
+}
+
+// Half the time a fresh board, otherwise the previous board with a new query
+// (the engines' per-board state is reused) or with a few squares flipped (the
+// same size with a new layout, which the engines have to notice)
+static TestCase nextCase(const TestCase* prev, std::mt19937& rng) {
+    int kind = prev ? std::uniform_int_distribution<int>(0, 3)(rng) : 0;
+    if (kind < 2) return randomCase(rng);
+    TestCase c = *prev;
+    if (kind == 3) {
+        std::uniform_int_distribution<int> cell(0, c.board.cells() - 1);
+        int flips = std::uniform_int_distribution<int>(1, MAX_FLIPS)(rng);
+        for (int i = 0; i < flips; i++) c.board.blocked[cell(rng)] ^= 1;
+        c.board.touch();
+    }
+    randomQuery(c, rng);
+    return c;
+}
+
+// --- Shrinking ---
+
+static bool cropTo(const TestCase& c, int size, TestCase& out) {
+    if (size < 1 || c.start.x >= size || c.start.y >= size || c.goal.x >= size || c.goal.y >= size) return false;
+    out = c;
+    out.board.size = size;
+    out.board.blocked.assign(size * size, 0);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) out.board.blocked[y * size + x] = c.board.blocked[y * c.board.size + x];
+    }
+    out.board.touch();
+    return true;
+}
+
+// Keeps applying simplifications that still fail until none is left
+static TestCase shrink(TestCase c) {
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        TestCase smaller;
+        if (cropTo(c, c.board.size - 1, smaller) && !runFresh(smaller).empty()) {
+            c = smaller;
+            progress = true;
+            continue;
+        }
+        for (int i = 0; i < c.board.cells(); i++) {
+            if (!c.board.blocked[i]) continue;
+            c.board.blocked[i] = 0;
+            c.board.touch();
+            if (!runFresh(c).empty()) {
+                progress = true;
+            } else {
+                c.board.blocked[i] = 1;
+                c.board.touch();
+            }
+        }
+    }
+    return c;
+}
+
+static void printCase(const TestCase& c) {
+    std::cout << pieceName(c.piece) << " on " << c.board.size << "x" << c.board.size
+              << " from (" << c.start.x << "," << c.start.y << ") to (" << c.goal.x << "," << c.goal.y << ")\n";
+    for (int y = 0; y < c.board.size; y++) {
+        std::cout << "  ";
+        for (int x = 0; x < c.board.size; x++) {
+            Point p = {x, y};
+            char ch = c.board.blocked[c.board.index(p)] ? '#' : '.';
+            if (p == c.start) ch = 'S';
+            if (p == c.goal) ch = (p == c.start) ? '*' : 'G';
+            std::cout << ch;
+        }
+        std::cout << "\n";
+    }
+}
+
+// --- Batch API ---
+
+const int BATCH_SIZE = 32;
+const int BATCH_QUERIES = 2000;
+const int BATCH_THREADS = 4;
+const double BATCH_DUMP_SECONDS = 0.001;
+
+// "label n=count ..." lines of writeLatencyLine(); false on anything else
+static bool parseDump(const std::string& text, std::vector<std::pair<std::string, uint64_t>>& lines) {
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string label, count;
+        if (!(fields >> label >> count) || count.compare(0, 2, "n=") != 0) return false;
+        lines.push_back({label, std::strtoull(count.c_str() + 2, nullptr, 10)});
+    }
+    return true;
+}
+
+// Empty string when a multithreaded, timed batch adds up
+static std::string checkBatch(uint32_t seed) {
+    std::mt19937 rng(seed);
+    Board board;
+    board.size = BATCH_SIZE;
+    board.blocked.assign(board.cells(), 0);
+    std::bernoulli_distribution block(0.2);
+    for (auto& b : board.blocked) b = block(rng) ? 1 : 0;
+    std::vector<Point> free;
+    for (int i = 0; i < board.cells(); i++) {
+        if (!board.blocked[i]) free.push_back(board.point(i));
+    }
+    std::uniform_int_distribution<size_t> pick(0, free.size() - 1);
+    std::uniform_int_distribution<int> piece(0, PIECE_COUNT - 1);
+    std::vector<BatchQuery> queries(BATCH_QUERIES);
+    uint64_t perPiece[PIECE_COUNT] = {};
+    for (auto& q : queries) {
+        q = {(PieceType)piece(rng), free[pick(rng)], free[pick(rng)]};
+        perPiece[q.piece]++;
+    }
+
+    BatchLatencies latencies;
+    std::ostringstream dumps;
+    BatchOptions options;
+    options.engine = ENGINE_ARRAY;
+    options.threads = BATCH_THREADS;
+    options.keepPaths = true;
+    options.latencies = &latencies;
+    options.dumpEverySeconds = BATCH_DUMP_SECONDS;
+    options.dumpTo = &dumps;
+    std::vector<BatchResult> results = runBatch(board, queries, options);
+
+    ReferenceEngine reference;
+    uint64_t nodes[PIECE_COUNT] = {};
+    for (size_t i = 0; i < queries.size(); i++) {
+        const BatchQuery& q = queries[i];
+        SearchResult want = reference.search(board, q.piece, q.start, q.goal);
+        SearchResult got;
+        got.distance = results[i].distance;
+        got.path = results[i].path;
+        std::string err = checkPath({board, q.piece, q.start, q.goal}, got);
+        if (got.distance != want.distance || !err.empty()) {
+            return "query " + std::to_string(i) + ": distance " + std::to_string(got.distance) + ", reference "
+                 + std::to_string(want.distance) + (err.empty() ? "" : ", " + err);
+        }
+        nodes[q.piece] += results[i].stats.nodesPopped;
+    }
+
+    std::string engine = engineName(options.engine);
+    for (int p = 0; p < PIECE_COUNT; p++) {
+        if (latencies.byPiece[p].count() != perPiece[p]) {
+            return std::string("latencies of ") + pieceName((PieceType)p) + ": "
+                 + std::to_string(latencies.byPiece[p].count()) + " values for " + std::to_string(perPiece[p]) + " queries";
+        }
+    }
+
+    // Snapshots are taken while the workers run: known labels, never above the final counts
+    std::vector<std::pair<std::string, uint64_t>> snapshot;
+    if (!parseDump(dumps.str(), snapshot)) return "unreadable latency snapshot:\n" + dumps.str();
+    if (snapshot.empty()) return "no latency snapshot during the batch";
+    for (const auto& line : snapshot) {
+        int p = 0;
+        while (p < PIECE_COUNT && line.first != engine + "/" + pieceName((PieceType)p)) p++;
+        if (p == PIECE_COUNT || line.second > perPiece[p]) {
+            return "latency snapshot " + line.first + " n=" + std::to_string(line.second);
+        }
+    }
+
+    std::vector<LabeledStats> series = batchStatsByPiece(queries, results, engine);
+    std::ostringstream prom;
+    writePrometheus(prom, series);
+    for (int p = 0; p < PIECE_COUNT; p++) {
+        if (perPiece[p] == 0) continue;
+        std::string labels = "{engine=\"" + engine + "\",piece=\"" + pieceName((PieceType)p) + "\"} ";
+        std::ostringstream want;
+        want.precision(9);
+        want << "chess_search_total" << labels << (double)perPiece[p] << "\n"
+             << "chess_search_nodes_popped_total" << labels << (double)nodes[p] << "\n";
+        std::string line;
+        std::istringstream expected(want.str());
+        while (std::getline(expected, line)) {
+            if (prom.str().find(line + "\n") == std::string::npos) return "Prometheus output lacks " + line;
+        }
+    }
+    std::printf("batch: %d queries on %d threads, %zu snapshot lines, %zu series\n", BATCH_QUERIES, BATCH_THREADS,
+                snapshot.size(), series.size());
+    return "";
+}
+
+int main(int argc, char** argv) {
+    int cases = 3000;
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--cases") == 0 && i + 1 < argc) cases = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else {
+            std::cerr << "usage: " << argv[0] << " [--cases N] [--seed N]" << std::endl;
+            return 2;
+        }
+    }
+
+    std::mt19937 rng(seed);
+    Engines engines = makeEngines();
+    TestCase prev;
+    for (int i = 0; i < cases; i++) {
+        TestCase c = nextCase(i > 0 ? &prev : nullptr, rng);
+        std::string err = runCase(c, engines);
+        if (err.empty()) {
+            prev = std::move(c);
+            continue;
+        }
+
+        std::cout << "FAIL case " << i << " (seed " << seed << "): " << err << "\n";
+        if (runFresh(c).empty()) {
+            // Only wrong on engines that carry state from the earlier cases
+            std::cout << "passes on fresh engines; previous case:\n";
+            printCase(prev);
+            std::cout << "failing case:\n";
+            printCase(c);
+            return 1;
+        }
+        TestCase small = shrink(c);
+        std::cout << "minimized: " << runFresh(small) << "\n";
+        printCase(small);
+        return 1;
+    }
+    std::cout << "ok: " << cases << " cases, " << ENGINE_COUNT << " engines agree (seed " << seed << ")" << std::endl;
+
+    std::string err = checkBatch(seed);
+    if (!err.empty()) {
+        std::cout << "FAIL batch (seed " << seed << "): " << err << std::endl;
+        return 1;
+    }
+    return 0;
+}
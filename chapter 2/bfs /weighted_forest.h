@@ -0,0 +1,259 @@
+// weighted_forest.h
+// Diameter, endpoints and center of every tree in a forest with edge
+// lengths, in one batch call (tree_diameter.py's Node.Distance counts edges;
+// here every edge has its own length).
+//
+// The forest comes in as a compact edge list (12 bytes per edge). Components
+// are found with a lock-free union-find over the edges, every component is
+// numbered by its smallest vertex, and the components are then handed to
+// the thread pool largest first. Each worker solves its components with two
+// sweeps (farthest vertex from anywhere, then farthest from that one) using
+// a per-thread scratch arena indexed by position inside the component, so a
+// component of c vertices costs O(c) memory and time however large n is.
+// One huge tree therefore runs on a single worker; use treeDiameter() for
+// that case.
+//
+// The center is the vertex on the diameter path with the smallest
+// eccentricity, max(d(a, v), d(b, v)); radius is that eccentricity. With
+// non-negative lengths that is the best vertex of the whole tree (the exact
+// center may lie inside an edge). Input with cycles is flagged by isForest;
+// the distances are then those of a spanning tree.
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "csr_graph.h"
+#include "thread_pool.h"
+
+struct WeightedEdge {
+    uint32_t u, v;
+    uint32_t length;
+};
+
+struct ComponentDiameter {
+    uint32_t root = NO_VERTEX; // smallest vertex of the component
+    uint32_t vertices = 0;
+    uint64_t length = 0;       // weighted diameter
+    uint32_t a = NO_VERTEX, b = NO_VERTEX;
+    uint32_t center = NO_VERTEX;
+    uint64_t radius = 0;
+};
+
+struct ForestDiameters {
+    std::vector<ComponentDiameter> components; // by root
+    std::vector<uint32_t> componentOf;         // per vertex, index into components
+    bool isForest = true;
+    double seconds = 0.0;
+};
+
+class WeightedForest {
+public:
+    WeightedForest(uint32_t n, const std::vector<WeightedEdge>& edges, ThreadPool& pool)
+        : n(n), pool(pool) {
+        buildAdjacency(edges);
+        findComponents(edges);
+    }
+
+    ForestDiameters solve() {
+        auto started = std::chrono::steady_clock::now();
+        ForestDiameters r;
+        r.components.resize(roots.size());
+        r.isForest = arcs.size() / 2 + roots.size() == n;
+
+        // Largest first, so a big tree does not start last
+        std::vector<uint32_t> order(roots.size());
+        for (uint32_t c = 0; c < order.size(); c++) order[c] = c;
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t x, uint32_t y) { return size(x) > size(y); });
+
+        std::vector<Scratch> scratch(pool.size());
+        pool.parallelFor(order.size(), 1, [&](size_t b, size_t e, int tid) {
+            for (size_t i = b; i < e; i++) r.components[order[i]] = solveComponent(order[i], scratch[tid]);
+        });
+        r.componentOf.resize(n);
+        pool.parallelFor(n, 1 << 16, [&](size_t b, size_t e, int) {
+            for (size_t v = b; v < e; v++) r.componentOf[v] = componentIndex[link[v]];
+        });
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        return r;
+    }
+
+    size_t bytes() const {
+        return offsets.size() * sizeof(uint64_t) + arcs.size() * sizeof(Arc)
+             + (link.size() + componentIndex.size() + roots.size() + position.size()) * sizeof(uint32_t)
+             + memberStart.size() * sizeof(uint64_t);
+    }
+
+private:
+    static const uint64_t UNSEEN = UINT64_MAX;
+    static const uint32_t PREFETCH_AHEAD = 8;
+
+    struct Arc {
+        uint32_t to, length;
+        bool operator<(const Arc& o) const { return to != o.to ? to < o.to : length < o.length; }
+    };
+
+    // Grow-only buffers of one worker, indexed by position in the component
+    struct Scratch {
+        std::vector<uint64_t> dist;
+        std::vector<uint32_t> parent;
+        std::vector<uint32_t> queue;
+    };
+
+    // Weighted CSR, built like buildCsr() but keeping duplicates
+    void buildAdjacency(const std::vector<WeightedEdge>& edges) {
+        const size_t GRAIN = 1 << 16;
+        std::vector<uint64_t> cursor(n + 1, 0);
+        pool.parallelFor(edges.size(), GRAIN, [&](size_t b, size_t e, int) {
+            for (size_t i = b; i < e; i++) {
+                if (edges[i].u == edges[i].v) continue;
+                __atomic_fetch_add(&cursor[edges[i].u + 1], 1, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&cursor[edges[i].v + 1], 1, __ATOMIC_RELAXED);
+            }
+        });
+        for (uint32_t v = 0; v < n; v++) cursor[v + 1] += cursor[v];
+        offsets = cursor;
+        arcs.resize(offsets[n]);
+        pool.parallelFor(edges.size(), GRAIN, [&](size_t b, size_t e, int) {
+            for (size_t i = b; i < e; i++) {
+                const WeightedEdge& w = edges[i];
+                if (w.u == w.v) continue;
+                arcs[__atomic_fetch_add(&cursor[w.u], 1, __ATOMIC_RELAXED)] = {w.v, w.length};
+                arcs[__atomic_fetch_add(&cursor[w.v], 1, __ATOMIC_RELAXED)] = {w.u, w.length};
+            }
+        });
+        // The scatter order depends on the threads; sorting keeps ties stable
+        pool.parallelFor(n, 1024, [&](size_t b, size_t e, int) {
+            for (size_t v = b; v < e; v++) std::sort(arcs.begin() + offsets[v], arcs.begin() + offsets[v + 1]);
+        });
+    }
+
+    uint32_t find(uint32_t v) {
+        while (true) {
+            uint32_t p = __atomic_load_n(&link[v], __ATOMIC_RELAXED);
+            if (p == v) return v;
+            uint32_t gp = __atomic_load_n(&link[p], __ATOMIC_RELAXED);
+            if (gp != p) __atomic_compare_exchange_n(&link[v], &p, gp, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED); // path halving
+            v = gp;
+        }
+    }
+
+    // Roots only ever hook under smaller roots, so a set's root is its minimum
+    void unite(uint32_t u, uint32_t v) {
+        while (true) {
+            uint32_t ru = find(u), rv = find(v);
+            if (ru == rv) return;
+            uint32_t hi = std::max(ru, rv), lo = std::min(ru, rv);
+            if (__atomic_compare_exchange_n(&link[hi], &hi, lo, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) return;
+        }
+    }
+
+    void findComponents(const std::vector<WeightedEdge>& edges) {
+        link.resize(n);
+        for (uint32_t v = 0; v < n; v++) link[v] = v;
+        pool.parallelFor(edges.size(), 1 << 14, [&](size_t b, size_t e, int) {
+            for (size_t i = b; i < e; i++) unite(edges[i].u, edges[i].v);
+        });
+        pool.parallelFor(n, 1 << 16, [&](size_t b, size_t e, int) {
+            for (size_t v = b; v < e; v++) link[v] = find((uint32_t)v);
+        });
+
+        // Components numbered in root order, positions in vertex order: one linear pass
+        componentIndex.assign(n, NO_VERTEX);
+        for (uint32_t v = 0; v < n; v++) {
+            if (link[v] == v) {
+                componentIndex[v] = (uint32_t)roots.size();
+                roots.push_back(v);
+            }
+        }
+        memberStart.assign(roots.size() + 1, 0);
+        for (uint32_t v = 0; v < n; v++) memberStart[componentIndex[link[v]] + 1]++;
+        for (size_t c = 0; c < roots.size(); c++) memberStart[c + 1] += memberStart[c];
+        std::vector<uint64_t> fill(memberStart.begin(), memberStart.end() - 1);
+        position.resize(n);
+        for (uint32_t v = 0; v < n; v++) {
+            uint32_t c = componentIndex[link[v]];
+            position[v] = (uint32_t)(fill[c]++ - memberStart[c]);
+        }
+    }
+
+    uint32_t size(uint32_t c) const { return (uint32_t)(memberStart[c + 1] - memberStart[c]); }
+
+    // Distances from src over its component, in BFS order so the vertices
+    // coming up are known and their cache misses can start early; returns
+    // the farthest vertex (the smallest id among ties)
+    uint32_t sweep(uint32_t c, uint32_t src, Scratch& s) {
+        uint32_t count = size(c);
+        std::fill(s.dist.begin(), s.dist.begin() + count, UNSEEN);
+        s.dist[position[src]] = 0;
+        s.parent[position[src]] = NO_VERTEX;
+        s.queue[0] = src;
+        uint32_t head = 0, tail = 1;
+        uint32_t far = src;
+        uint64_t farDist = 0;
+        while (head < tail) {
+            if (head + PREFETCH_AHEAD < tail) {
+                uint32_t ahead = s.queue[head + PREFETCH_AHEAD];
+                __builtin_prefetch(&offsets[ahead]);
+                __builtin_prefetch(&arcs[offsets[ahead]]);
+            }
+            uint32_t u = s.queue[head++];
+            uint64_t du = s.dist[position[u]];
+            if (du > farDist || (du == farDist && u < far)) {
+                far = u;
+                farDist = du;
+            }
+            for (uint64_t i = offsets[u]; i < offsets[u + 1]; i++) {
+                uint32_t v = arcs[i].to, pv = position[v];
+                if (s.dist[pv] != UNSEEN) continue;
+                s.dist[pv] = du + arcs[i].length;
+                s.parent[pv] = u;
+                s.queue[tail++] = v;
+            }
+        }
+        return far;
+    }
+
+    ComponentDiameter solveComponent(uint32_t c, Scratch& s) {
+        ComponentDiameter d;
+        d.root = roots[c];
+        d.vertices = size(c);
+        if (s.dist.size() < d.vertices) {
+            s.dist.resize(d.vertices);
+            s.parent.resize(d.vertices);
+            s.queue.resize(d.vertices);
+        }
+        d.a = sweep(c, d.root, s);
+        d.b = sweep(c, d.a, s);
+        d.length = s.dist[position[d.b]];
+
+        // Walk b .. a; ecc(v) = max(d(a, v), d(v, b)) for v on the path
+        d.center = d.b;
+        d.radius = d.length;
+        for (uint32_t v = d.b; v != NO_VERTEX; v = s.parent[position[v]]) {
+            uint64_t fromA = s.dist[position[v]];
+            uint64_t ecc = std::max(fromA, d.length - fromA);
+            if (ecc < d.radius) {
+                d.radius = ecc;
+                d.center = v;
+            }
+        }
+        return d;
+    }
+
+    uint32_t n;
+    ThreadPool& pool;
+    std::vector<uint64_t> offsets;
+    std::vector<Arc> arcs;
+    std::vector<uint32_t> link;           // union-find parents, then each vertex's root
+    std::vector<uint32_t> componentIndex; // per root
+    std::vector<uint32_t> roots;
+    std::vector<uint64_t> memberStart;    // prefix sums of component sizes
+    std::vector<uint32_t> position;       // index of each vertex inside its component
+};
+
+inline ForestDiameters forestDiameters(uint32_t n, const std::vector<WeightedEdge>& edges, ThreadPool& pool) {
+    WeightedForest forest(n, edges, pool);
+    return forest.solve();
+}